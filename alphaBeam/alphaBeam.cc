@@ -26,6 +26,7 @@
 //
 
 #include "G4RunManagerFactory.hh"
+#include "G4Version.hh"
 #include "G4UImanager.hh"
 #include "G4UIExecutive.hh"
 #include "G4VisExecutive.hh"
@@ -34,6 +35,15 @@
 #include "DetectorConstruction.hh"
 #include "PhysicsList.hh"
 #include "CommandLineParser.hh"
+#include "PhaseSpaceSink.hh"
+#include "ParameterSweep.hh"
+#include "WorkerInitialization.hh"
+#include "EventSeed.hh"
+#include "RecordFilter.hh"
+#include "EventWatchdog.hh"
+#include "RecordAndKill.hh"
+#include "RecordConsumerSet.hh"
+#include "Telemetry.hh"
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 using namespace G4DNAPARSER;
@@ -47,6 +57,13 @@ int main(int argc, char **argv)
 
   Command *commandLine(0);
 
+  // records go to stdout, everything printed from here on to stderr
+  if ((commandLine = parser->GetCommandIfActive("-out")) &&
+      G4StrUtil::starts_with(commandLine->GetOption(), "stdout:"))
+  {
+    PhaseSpaceSink::ReserveStdout();
+  }
+
   int mySeed{1};
   if ((commandLine = parser->GetCommandIfActive("-seed")))
   {
@@ -54,9 +71,97 @@ int main(int argc, char **argv)
   }
 
   G4Random::setTheSeed(mySeed);
+  EventSeed::SetMasterSeed(mySeed);
   G4Random::showEngineStatus();
 
-  std::unique_ptr<G4RunManager> pRunManager(G4RunManagerFactory::CreateRunManager(G4RunManagerType::SerialOnly));
+  // -runmanager picks the backend; with only -threads, Geant4's default
+  // (tasking unless overridden by G4RUN_MANAGER_TYPE) is used
+  G4RunManagerType runManagerType = G4RunManagerType::SerialOnly;
+  G4int numThreads{0};
+  if ((commandLine = parser->GetCommandIfActive("-threads")))
+  {
+    numThreads = strtol(commandLine->GetOption(), NULL, 10);
+    runManagerType = G4RunManagerType::Default;
+  }
+  if ((commandLine = parser->GetCommandIfActive("-runmanager")))
+  {
+    const G4String &backend = commandLine->GetOption();
+    if (backend == "serial")
+      runManagerType = G4RunManagerType::SerialOnly;
+    else if (backend == "mt")
+      runManagerType = G4RunManagerType::MTOnly;
+    else if (backend == "tasking")
+      runManagerType = G4RunManagerType::TaskingOnly;
+    else if (backend == "tbb")
+      runManagerType = G4RunManagerType::TBBOnly;
+    else
+    {
+      G4ExceptionDescription description;
+      description << "unknown run manager '" << backend << "', expected serial, mt, tasking or tbb";
+      G4Exception("main", "alphaBeam002", FatalException, description);
+    }
+  }
+#if G4VERSION_NUMBER >= 1120
+  G4int subEventSize{0};
+#endif
+  if ((commandLine = parser->GetCommandIfActive("-subevents")))
+  {
+#if G4VERSION_NUMBER >= 1120
+    runManagerType = G4RunManagerType::SubEvtOnly;
+    subEventSize = commandLine->GetOption().empty() ? 100 : strtol(commandLine->GetOption(), NULL, 10);
+#else
+    G4Exception("main", "alphaBeam001", JustWarning,
+                "-subevents needs Geant4 11.2 or later, running whole events");
+#endif
+  }
+
+  if (parser->GetCommandIfActive("-replay") && runManagerType != G4RunManagerType::SerialOnly)
+  {
+    // every worker would replay the whole list
+    G4Exception("main", "alphaBeam004", JustWarning, "-replay runs single-threaded, ignoring -threads, -runmanager and -subevents");
+    runManagerType = G4RunManagerType::SerialOnly;
+    numThreads = 0;
+#if G4VERSION_NUMBER >= 1120
+    subEventSize = 0;
+#endif
+  }
+
+  std::unique_ptr<G4RunManager> pRunManager(G4RunManagerFactory::CreateRunManager(runManagerType));
+#if G4VERSION_NUMBER >= 1120
+  // decay products are collected into sub-events of up to this many tracks
+  if (subEventSize > 0)
+    pRunManager->RegisterSubEventType(0, subEventSize);
+#endif
+  if (numThreads > 0)
+    pRunManager->SetNumberOfThreads(numThreads);
+
+  if (pRunManager->GetRunManagerType() != G4RunManager::sequentialRM &&
+      (commandLine = parser->GetCommandIfActive("-out")) &&
+      G4StrUtil::starts_with(commandLine->GetOption(), "stdout:"))
+  {
+    G4Exception("main", "alphaBeam003", FatalException,
+                "-out stdout: needs a single-threaded run, use fifo: or unix: with threads");
+  }
+
+  if ((commandLine = parser->GetCommandIfActive("-pin")))
+  {
+    auto placement = WorkerInitialization::ParsePlacement(commandLine->GetOption());
+    // a sequential run manager rejects worker initialisations
+    if (pRunManager->GetRunManagerType() == G4RunManager::sequentialRM)
+    {
+      if (placement != WorkerInitialization::Placement::None)
+        G4Exception("main", "alphaBeam005", JustWarning, "-pin needs worker threads, ignored in a sequential run");
+    }
+    else if (placement != WorkerInitialization::Placement::None)
+      pRunManager->SetUserInitialization(new WorkerInitialization(placement));
+  }
+
+  if ((commandLine = parser->GetCommandIfActive("-consumer")))
+    RecordConsumerSet::LoadLibraries(commandLine->GetOption());
+
+  // before the user actions are built, they look up their thread's counters
+  if ((commandLine = parser->GetCommandIfActive("-telemetry")))
+    Telemetry::Start(commandLine->GetOption());
 
   DetectorConstruction *pDetector = new DetectorConstruction();
   pRunManager->SetUserInitialization(pDetector);
@@ -67,6 +172,14 @@ int main(int argc, char **argv)
 
 
   G4UImanager *UImanager = G4UImanager::GetUIpointer();
+  RecordFilter::Instance(); // creates the /filter/ commands
+  EventWatchdog::Instance(); // and the /watchdog/ commands
+  RecordAndKill::Instance(); // and the /kill/ commands
+
+  // replayed events are for looking at: full tracking output unless the
+  // macro says otherwise
+  if (parser->GetCommandIfActive("-replay"))
+    UImanager->ApplyCommand("/tracking/verbose 1");
 
   if ((commandLine = parser->GetCommandIfActive("-mac")))
   {
@@ -74,6 +187,12 @@ int main(int argc, char **argv)
     UImanager->ApplyCommand(command + commandLine->GetOption());
   }
 
+  if ((commandLine = parser->GetCommandIfActive("-sweep")))
+  {
+    ParameterSweep sweep(commandLine->GetOption());
+    sweep.Run();
+  }
+
   if ((commandLine = parser->GetCommandIfActive("-gui")))
   {
     // initialize visualization
@@ -91,6 +210,7 @@ int main(int argc, char **argv)
     delete visManager;
   }
 
+  Telemetry::Stop();
   return 0;
 }
 
@@ -144,9 +264,99 @@ void Parse(int &argc, char **argv)
 
   parser->AddCommand("-out",
                      Command::OptionNotCompulsory,
-                     "Output files (ROOT is used by default)",
+                     "Output files (ROOT is used by default); fifo:path, unix:path "
+                     "or stdout: stream the phase space instead of writing name.bin",
                      exec);
 
+  parser->AddCommand("-backend",
+                     Command::WithOption,
+                     "TrackingData output backend: g4 (default), tree, rntuple or none (no ROOT file)",
+                     "g4");
+
+  parser->AddCommand("-compression",
+                     Command::WithOption,
+                     "ROOT compression setting for the tree and rntuple backends "
+                     "(algorithm*100 + level)",
+                     "505");
+
+  parser->AddCommand("-psformat",
+                     Command::WithOption,
+                     "Phase-space file format: float (default), compact, compact-zlib or none (no file)",
+                     "float");
+
+  parser->AddCommand("-lineage",
+                     Command::WithoutOption,
+                     "Add trackID, parentID and the track's voxel-entry count to every "
+                     "phase-space record (15 floats in the float format)");
+
+  parser->AddCommand("-psvoxel",
+                     Command::WithoutOption,
+                     "Add the voxel's lattice indices i and j to every phase-space record "
+                     "(needed by psSort)");
+
+  parser->AddCommand("-firstentry",
+                     Command::OptionNotCompulsory,
+                     "Record only a track's first voxel entry in each Z layer (layer, "
+                     "default) or in the whole lattice (lattice)",
+                     "layer");
+
+  parser->AddCommand("-species",
+                     Command::WithOption,
+                     "Particle classes recorded at the voxels, comma separated: e-, gamma, "
+                     "alpha, proton, ion, other or all; ion and other add the PDG code to "
+                     "the phase-space records",
+                     "e-,gamma,alpha,proton");
+
+  parser->AddCommand("-sweep",
+                     Command::WithOption,
+                     "Run every detector configuration in the sweep file after the "
+                     "macro, reusing the physics tables",
+                     "sweep.txt");
+
+  parser->AddCommand("-threads",
+                     Command::WithOption,
+                     "Number of worker threads (runs single-threaded if not given)",
+                     "4");
+
+  parser->AddCommand("-runmanager",
+                     Command::WithOption,
+                     "Run manager backend: serial, mt, tasking or tbb",
+                     "tasking");
+
+  parser->AddCommand("-pin",
+                     Command::WithOption,
+                     "Pin worker threads: none, core (one CPU each) or numa (one NUMA node each)",
+                     "numa");
+
+  parser->AddCommand("-subevents",
+                     Command::OptionNotCompulsory,
+                     "Split events: radioactive-decay products are sent as sub-events "
+                     "of up to N tracks to the worker threads (Geant4 >= 11.2)",
+                     "100");
+
+  parser->AddCommand("-replay",
+                     Command::WithOption,
+                     "Re-simulate only the listed events (e.g. 57,1200-1203) with "
+                     "their original seeds and tracking output",
+                     "eventIDs");
+
+  parser->AddCommand("-consumer",
+                     Command::WithOption,
+                     "Load record consumer plugins: lib.so[:args][,lib2.so[:args]...] "
+                     "(see RecordConsumer.hh)",
+                     "libLayerTally.so");
+
+  parser->AddCommand("-telemetry",
+                     Command::WithOption,
+                     "Rewrite a status file (JSON, or Prometheus text if it ends in .prom) "
+                     "every N seconds: file[:N], N = 10 by default",
+                     "status.json");
+
+  parser->AddCommand("-score",
+                     Command::WithoutOption,
+                     "Score energy deposit, dose and fluence per voxel "
+                     "(written to <out>_voxels.bin)");
+
   //////////
   // If -h or --help is given in option : print help and exit
   //
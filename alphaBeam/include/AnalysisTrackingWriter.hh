@@ -0,0 +1,51 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file AnalysisTrackingWriter.hh
+/// \brief Definition of the AnalysisTrackingWriter class
+
+#pragma once
+#include "TrackingDataWriter.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Default backend: row-wise G4AnalysisManager ntuples with double columns.
+
+class AnalysisTrackingWriter : public TrackingDataWriter
+{
+public:
+    AnalysisTrackingWriter() = default;
+    ~AnalysisTrackingWriter() override = default;
+
+    G4bool Open(const G4String &fileName) override;
+    void Fill(const VoxelEntryRecord &record) override;
+    void Close(const RunInfo &info) override;
+
+private:
+    G4String fFileName;
+    std::vector<G4int> fSkippedEvents; // bound to the Skipped column
+    std::vector<G4int> fCellsPerShell; // bound to the NumCells column
+};
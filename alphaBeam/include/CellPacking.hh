@@ -0,0 +1,92 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+//
+/// \file CellPacking.hh
+/// \brief Definition of the CellPacking class
+
+#pragma once
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+#include <cstdint>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Random non-overlapping cells (nuclei) for the random placement of
+// DetectorConstruction: unrotated cubes or spheres of half-size h, in
+//   slab    |x|, |y| < halfWidth, startZ < z < startZ + thickness
+//   sphere  radius R around (0, 0, startZ + R)
+// by random sequential addition: candidate centres are drawn uniformly where
+// the cell fits in the region and rejected if they overlap a placed cell,
+// looked up in a SpatialHash holding one centre per cell, so a million cells
+// take seconds. The draws come from their own MixMax engine seeded by the
+// spec, not the Geant4 one, so a spec always gives the same layout.
+// Addition jams well below close packing (about 38% volume fraction for
+// spheres); after kAttemptsPerCell rejections per requested cell it stops
+// with a warning.
+//
+// Layouts are cached in a file and reused when its spec matches:
+//   char[8]  "ABCELLS2"
+//   uint32   shape (0 box, 1 orb), region (0 slab, 1 sphere),
+//            cells requested, cells placed
+//   double   h, halfWidth, thickness, R, startZ [mm]
+//   uint64   seed
+//   int32    x, y, z [0.01 nm]  x cells placed
+// Centres are drawn on the 0.01 nm grid, so a reloaded layout is exact.
+
+class CellPacking
+{
+public:
+    enum Shape { kBox, kOrb };
+    enum Region { kSlab, kSphere };
+
+    struct Spec
+    {
+        Shape shape{kBox};
+        Region region{kSlab};
+        G4int numCells{0};
+        G4double halfSize{0};
+        G4double halfWidth{0};
+        G4double thickness{0};
+        G4double radius{0};
+        G4double startZ{0};
+        std::uint64_t seed{1};
+    };
+
+    static constexpr G4int kAttemptsPerCell = 100;
+
+    // from the cache file if it holds this spec, else generated and saved
+    // there; no file name means no cache
+    static std::vector<G4ThreeVector> Place(const Spec &, const G4String &fileName);
+
+    static std::vector<G4ThreeVector> Generate(const Spec &);
+    static G4bool Load(const G4String &fileName, const Spec &, std::vector<G4ThreeVector> &centres);
+    static void Save(const G4String &fileName, const Spec &, const std::vector<G4ThreeVector> &centres);
+
+    // lower corner of the box enclosing the region
+    static G4ThreeVector GetRegionMin(const Spec &);
+};
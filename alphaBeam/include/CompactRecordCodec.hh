@@ -0,0 +1,184 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CompactRecordCodec.hh
+/// \brief Definition of the CompactRecordCodec class
+
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+struct VoxelEntryRecord;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Quantised phase-space record, 17 bytes when eventID and copyNo repeat:
+//
+//   uint8    tag: bits 0-2 particleID, bit 3 eventID delta follows,
+//                 bit 4 copyNo delta follows, bits 5-7 reserved (0)
+//   varint   zigzag eventID delta   (only with tag bit 3)
+//   varint   zigzag copyNo delta    (only with tag bit 4)
+//   varint   zigzag PDG code        (species only, particleID 5 and 6)
+//   float    excitation energy [MeV] (species only, particleID 5)
+//   varint   zigzag trackID delta   (lineage only)
+//   varint   zigzag trackID - parentID (lineage only)
+//   varint   zigzag entry           (lineage only)
+//   varint   zigzag voxel i, j      (voxel only)
+//   uint16   direction, octahedral u
+//   uint16   direction, octahedral v
+//   int16    local x, y, z as fixed point of the voxel half-size h
+//   uint16   kinetic energy, log10 scale from 1 eV to 10 GeV (0 = zero)
+//   float    global time [s]
+//
+// Precision loss:
+//   position   |dx| <= h / 65534         (0.0026 nm for h = 170 nm)
+//   direction  angle error <= 7e-5 rad
+//   energy     relative error <= 1.8e-4 from 1 eV to 10 GeV; energies
+//              outside that range are clamped to 1 eV or 10 GeV
+//   time       unchanged (float, as in the float format)
+// particleID 1-4 imply their PDG code; without the species field the
+// excitation energy is not stored, as those are never excited.
+// Deltas are taken from the previous record of the same block, so each
+// block decodes on its own.
+
+class CompactRecordCodec
+{
+public:
+    // tag byte + fixed part + eight worst-case 32-bit varints + excitation
+    static const std::size_t kMaxRecordSize = 1 + 16 + 8 * 5 + 4;
+
+    static const std::uint8_t kEventFlag = 0x08;
+    static const std::uint8_t kCopyNoFlag = 0x10;
+
+    explicit CompactRecordCodec(double halfSize_mm, bool lineage = false, bool voxel = false,
+                                bool species = false)
+        : fHalfSize(halfSize_mm), fLineage(lineage), fVoxel(voxel), fSpecies(species) {}
+
+    // start of a block: the next record carries absolute IDs
+    void Reset()
+    {
+        fLastEventID = 0;
+        fLastCopyNo = 0;
+        fLastTrackID = 0;
+        fFirst = true;
+    }
+
+    // returns the number of bytes written to out
+    std::size_t Encode(const VoxelEntryRecord &record, std::uint8_t *out);
+
+    //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+    static void EncodeDirection(double x, double y, double z, std::uint16_t uv[2])
+    {
+        double norm = std::fabs(x) + std::fabs(y) + std::fabs(z);
+        double px = x / norm;
+        double py = y / norm;
+        if (z < 0)
+        {
+            double ox = (1 - std::fabs(py)) * SignNotZero(px);
+            double oy = (1 - std::fabs(px)) * SignNotZero(py);
+            px = ox;
+            py = oy;
+        }
+        uv[0] = (std::uint16_t)std::lround((std::clamp(px, -1., 1.) * 0.5 + 0.5) * 65535.);
+        uv[1] = (std::uint16_t)std::lround((std::clamp(py, -1., 1.) * 0.5 + 0.5) * 65535.);
+    }
+
+    static void DecodeDirection(const std::uint16_t uv[2], double &x, double &y, double &z)
+    {
+        double px = uv[0] / 65535. * 2 - 1;
+        double py = uv[1] / 65535. * 2 - 1;
+        double pz = 1 - std::fabs(px) - std::fabs(py);
+        if (pz < 0)
+        {
+            double ox = (1 - std::fabs(py)) * SignNotZero(px);
+            double oy = (1 - std::fabs(px)) * SignNotZero(py);
+            px = ox;
+            py = oy;
+        }
+        double norm = std::sqrt(px * px + py * py + pz * pz);
+        x = px / norm;
+        y = py / norm;
+        z = pz / norm;
+    }
+
+    static std::int16_t EncodePosition(double x, double halfSize)
+    {
+        return (std::int16_t)std::lround(std::clamp(x / halfSize, -1., 1.) * 32767.);
+    }
+
+    static double DecodePosition(std::int16_t q, double halfSize)
+    {
+        return q / 32767. * halfSize;
+    }
+
+    static std::uint16_t EncodeEnergy(double energy_MeV)
+    {
+        if (energy_MeV <= 0)
+            return 0;
+        double t = (std::log10(energy_MeV) - kLogEMin) / (kLogEMax - kLogEMin);
+        return (std::uint16_t)std::lround(1 + std::clamp(t, 0., 1.) * 65534.);
+    }
+
+    static double DecodeEnergy(std::uint16_t q)
+    {
+        if (q == 0)
+            return 0;
+        return std::pow(10., kLogEMin + (q - 1) / 65534. * (kLogEMax - kLogEMin));
+    }
+
+    static std::size_t PutVarint(std::int64_t value, std::uint8_t *out)
+    {
+        std::uint64_t zigzag = ((std::uint64_t)value << 1) ^ (std::uint64_t)(value >> 63);
+        std::size_t n = 0;
+        while (zigzag >= 0x80)
+        {
+            out[n++] = (std::uint8_t)(zigzag | 0x80);
+            zigzag >>= 7;
+        }
+        out[n++] = (std::uint8_t)zigzag;
+        return n;
+    }
+
+private:
+    static double SignNotZero(double v) { return v >= 0 ? 1. : -1.; }
+
+    // energy range of the log scale, log10(MeV)
+    static constexpr double kLogEMin = -6.;
+    static constexpr double kLogEMax = 4.;
+
+    double fHalfSize;
+    bool fLineage;
+    bool fVoxel;
+    bool fSpecies;
+    std::int32_t fLastEventID{0};
+    std::int32_t fLastCopyNo{0};
+    std::int32_t fLastTrackID{0};
+    bool fFirst{true};
+};
@@ -28,8 +28,13 @@
 #include <memory>
 #include "G4RotationMatrix.hh"
 #include "DetectorMessenger.hh"
+#include "G4VPhysicalVolume.hh"
+#include "VoxelLattice.hh"
+#include "CellPacking.hh"
 
 class G4VPhysicalVolume;
+class G4LogicalVolume;
+class G4UserLimits;
 class DetectorMessenger;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
@@ -38,6 +43,35 @@ class DetectorConstruction
     : public G4VUserDetectorConstruction
 {
 public:
+    // How voxels are grouped under the water volume:
+    //   flat  - all voxels are daughters of water
+    //   layer - one water slab per Z layer holds that layer's voxels
+    //   row   - as layer, with one water bar per (Y, Z) row inside each slab
+    enum VoxelLayout { kFlat, kLayer, kRow };
+
+    // Where the voxels are:
+    //   lattice - the regular ndiv_X x ndiv_Y x ndiv_Z lattice
+    //   random  - non-overlapping cells packed at random (CellPacking),
+    //             copyNo the depth bin of spacing from start_Z
+    //   radial  - cells spacing apart on cylindrical shells around the
+    //             line source (z axis), copyNo the shell
+    // The random and radial placements are always flat.
+    enum Placement { kLatticePlacement, kRandomPlacement, kRadialPlacement };
+
+    struct ShellSpec
+    {
+        G4double rMin;      // radius of the innermost shell
+        G4double spacing;   // between shells
+        G4int number;
+        G4double length;    // along z, centred on z = 0
+    };
+
+    // Volumes sharing one set of user limits. The water class covers the
+    // envelope and the layer/row mothers.
+    enum VolumeClass { kVoxelVolume, kWaterVolume, kWorldVolume, kNumVolumeClasses };
+    static VolumeClass ParseVolumeClass(const G4String &);
+    static const char *GetVolumeClassName(VolumeClass);
+
     DetectorConstruction();
     ~DetectorConstruction() override;
     G4VPhysicalVolume *Construct() override;
@@ -46,10 +80,47 @@ public:
     void set_ndiv_X (G4int);
     void set_ndiv_Y(G4int);
     void set_ndiv_Z(G4int);
+    void set_layout(const G4String &);
+    void set_placement(const G4String &);
+    // Construct() takes the cell half-size from the voxel and startZ from
+    // start_Z
+    void set_cellSpec(const CellPacking::Spec &);
+    void set_cellFile(const G4String &);
+    void set_shellSpec(const ShellSpec &);
+    // times navigation-only rays through the current geometry, see NavigationBenchmark
+    void benchmark_navigation(G4int numRays);
     DetectorMessenger* fDetectorMessenger;
-    G4double get_spacing() { return spacing; }
-    G4double get_start_Z() { return start_Z; }
+    G4double get_spacing() const { return spacing; }
+    G4double get_start_Z() const { return start_Z; }
+    G4int get_ndiv_X() const { return ndiv_X; }
+    G4int get_ndiv_Y() const { return ndiv_Y; }
+    G4int get_ndiv_Z() const { return ndiv_Z; }
+    G4double get_voxelHalfSize() const { return fLattice.GetHalfSize(); }
+    G4double get_voxelMass() const { return fVoxelMass; }
+    G4double get_voxelVolume() const { return fVoxelVolume; }
+    VoxelLayout get_layout() const { return fLayout; }
+    Placement get_placement() const { return fPlacement; }
+    const CellPacking::Spec &get_cellSpec() const { return fCellSpec; }
+    const ShellSpec &get_shellSpec() const { return fShellSpec; }
+
+    // Limits are attached to the logical volumes in Construct() and can be
+    // changed between runs; they are enforced by G4StepLimiterPhysics.
+    G4UserLimits *get_userLimits(VolumeClass volumeClass) const { return fUserLimits[volumeClass]; }
+    VolumeClass get_volumeClass(const G4LogicalVolume *lv) const;
+    // where the voxels are, valid after Construct()
+    const VoxelLattice &get_lattice() const { return fLattice; }
+
+    // Voxels are placed in voxel-ID order, (i*ndiv_Y + j)*ndiv_Z + k, so the
+    // ID is the offset of the placement's instance ID from the first voxel.
+    // Returns -1 for any other volume.
+    G4int get_voxelID(const G4VPhysicalVolume *pv) const
+    {
+        G4int id = pv->GetInstanceID() - fFirstVoxelInstance;
+        return (id >= 0 && id < fNumVoxels) ? id : -1;
+    }
 private:
+    // builds fLattice for the random or radial placement and places its cells
+    G4int PlaceCells(G4LogicalVolume *logicVoxel, G4LogicalVolume *logicWater, G4double halfSize);
 
     G4double spacing;
     G4double start_Z;
@@ -57,4 +128,17 @@ private:
     G4int ndiv_X;
     G4int ndiv_Y;
     G4int ndiv_Z;
+
+    VoxelLayout fLayout{kFlat};
+    Placement fPlacement{kLatticePlacement};
+    CellPacking::Spec fCellSpec;
+    G4String fCellFile;
+    ShellSpec fShellSpec;
+    G4UserLimits *fUserLimits[kNumVolumeClasses];
+
+    G4double fVoxelMass{0};
+    G4double fVoxelVolume{0};
+    VoxelLattice fLattice;
+    G4int fFirstVoxelInstance{0};
+    G4int fNumVoxels{0};
 };
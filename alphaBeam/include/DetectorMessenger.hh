@@ -64,6 +64,35 @@ class DetectorMessenger: public G4UImessenger
     G4UIcmdWithAnInteger* ndiv_X;
     G4UIcmdWithAnInteger* ndiv_Y;
     G4UIcmdWithAnInteger* ndiv_Z;
+    G4UIcmdWithAString* layout;
+    G4UIcmdWithAnInteger* benchmarkNavigation;
+    G4UIcmdWithAnInteger* benchmarkStepping;
+    G4UIcmdWithAString* placement;
+
+    // /det/cells/: the random placement
+    G4UIdirectory* cellsDir;
+    G4UIcmdWithAnInteger* cellNumber;
+    G4UIcmdWithAString* cellShape;
+    G4UIcommand* cellSlab;
+    G4UIcmdWithADoubleAndUnit* cellSphere;
+    G4UIcmdWithAnInteger* cellSeed;
+    G4UIcmdWithAString* cellFile;
+
+    // /det/shells/: the radial placement
+    G4UIdirectory* shellsDir;
+    G4UIcmdWithADoubleAndUnit* shellRMin;
+    G4UIcmdWithADoubleAndUnit* shellSpacing;
+    G4UIcmdWithAnInteger* shellNumber;
+    G4UIcmdWithADoubleAndUnit* shellLength;
+
+    // /det/limits/<limit> <voxel|water|world> <value> <unit>
+    G4UIdirectory* limitsDir;
+    G4UIcommand* maxStep;
+    G4UIcommand* maxTrackLength;
+    G4UIcommand* maxTime;
+    G4UIcommand* minEkin;
+    G4UIcommand* MakeLimitCommand(const char* name, const char* guidance,
+                                  const char* defaultUnit, const char* unitCategory);
 
 };
 
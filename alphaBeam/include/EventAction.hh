@@ -34,6 +34,7 @@
 #include "G4UserEventAction.hh"
 #include "globals.hh"
 #include "G4ThreeVector.hh"
+#include "Telemetry.hh"
 #include <map>
 class EventAction : public G4UserEventAction
 {
@@ -50,6 +51,7 @@ public:
 
 private:
   G4double totalPrimaryDecayTime{0};
+  Telemetry::Counters *fTelemetry;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,111 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventArena.hh
+/// \brief Definition of the EventArena class
+
+#pragma once
+#include "globals.hh"
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Per-thread bump allocator for objects that live for one event (the
+// event's record buffer, hit objects). Allocation moves a pointer through
+// a list of chunks; EventAction rewinds it at the end of every event and
+// the chunks are reused, so once the chunks cover the largest event so far
+// nothing more is taken from the heap. Destructors are never run: only put
+// objects here that own no other memory.
+//
+// The statistics show whether that steady state was reached: chunks taken
+// from the heap after the first event of a run mean an event outgrew all
+// earlier ones.
+
+class EventArena
+{
+public:
+    explicit EventArena(std::size_t chunkSize = 256*1024);
+    ~EventArena();
+    EventArena(const EventArena &) = delete;
+    EventArena &operator=(const EventArena &) = delete;
+
+    void *Allocate(std::size_t size, std::size_t alignment)
+    {
+        ++fNumObjects;
+        std::size_t offset = (fOffset + alignment - 1) & ~(alignment - 1);
+        if (fCurrent < fChunks.size() && offset + size <= fChunks[fCurrent].size)
+        {
+            fOffset = offset + size;
+            return fChunks[fCurrent].data + offset;
+        }
+        return AllocateSlow(size, alignment);
+    }
+
+    template <class T, class... Args>
+    T *New(Args &&...args)
+    {
+        return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    }
+
+    template <class T>
+    T *NewArray(std::size_t n)
+    {
+        return new (Allocate(n*sizeof(T), alignof(T))) T[n];
+    }
+
+    // end of event: everything allocated since the last Reset is released
+    void Reset();
+
+    void ResetStatistics();
+    void MergeStatistics(const EventArena &other);
+    void PrintStatistics() const;
+
+private:
+    struct Chunk
+    {
+        char *data;
+        std::size_t size;
+    };
+
+    void *AllocateSlow(std::size_t size, std::size_t alignment);
+    std::size_t UsedBytes() const;
+
+    std::size_t fChunkSize;
+    std::vector<Chunk> fChunks;
+    std::size_t fCurrent{0};  // chunk being filled
+    std::size_t fOffset{0};   // into fChunks[fCurrent]
+
+    G4long fNumEvents{0};
+    G4long fNumObjects{0};
+    G4long fNumChunkAllocations{0};
+    G4long fNumLateChunkAllocations{0}; // after the first event of the run
+    G4double fTotalBytes{0};
+    std::size_t fPeakEventBytes{0};
+    std::size_t fHeldBytes{0};         // own chunks, plus the workers' once merged
+};
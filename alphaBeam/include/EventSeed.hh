@@ -0,0 +1,60 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventSeed.hh
+/// \brief Definition of the EventSeed class
+
+#pragma once
+#include "globals.hh"
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Per-event random seeds. The engine is reseeded at the start of every event
+// from a hash of (master seed, eventID), so an event's history depends on
+// nothing but these two numbers: not on the events before it, nor on the
+// thread that runs it. Only the master seed (-seed) needs to be recorded;
+// it is written to the Info table.
+//
+// With -replay id,id,... the k-th event of each run is re-simulated as the
+// k-th listed event, with its eventID and seeds, and the run stops after
+// the last one.
+
+class EventSeed
+{
+public:
+    static void SetMasterSeed(G4long seed) { fgMasterSeed = seed; }
+    static G4long GetMasterSeed() { return fgMasterSeed; }
+
+    // reseeds the engine of the calling thread for eventID
+    static void Apply(G4int eventID);
+
+    // parses "57,1203" or "10-20,57"
+    static std::vector<G4int> ParseEventList(const G4String &list);
+
+private:
+    static G4long fgMasterSeed;
+};
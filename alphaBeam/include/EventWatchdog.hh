@@ -0,0 +1,136 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventWatchdog.hh
+/// \brief Definition of the EventWatchdog class
+
+#pragma once
+#include "globals.hh"
+#include <chrono>
+#include <climits>
+#include <memory>
+#include <vector>
+
+class G4Step;
+class EventWatchdogMessenger;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Per-event wall-time and step budgets, set with /watchdog/:
+//     /watchdog/maxTime 10 min
+//     /watchdog/maxSteps 100000000
+//     /watchdog/action abort          warn, abort (default) or spool
+//     /watchdog/spoolFile skipped.txt
+// An event over budget is logged with its master seed and eventID (enough
+// to re-simulate it with -seed and -replay) and a summary of the track
+// being stepped and of the tracks still stacked. With abort it is then
+// aborted and its eventID written to the Skipped column of the Info table;
+// spool does the same and also appends the eventID to the spool file, for
+// a later -replay run with looser budgets. warn only logs.
+//
+// With a budget set, the end-of-run report includes the distribution of
+// event wall times.
+
+class EventWatchdog
+{
+public:
+    enum class Action
+    {
+        Warn,
+        Abort,
+        Spool
+    };
+
+    static EventWatchdog *Instance();
+    ~EventWatchdog();
+
+    void SetMaxTime(G4double time) { fMaxTime = time; }
+    void SetMaxSteps(G4long steps) { fMaxSteps = steps; }
+    void SetAction(const G4String &name);
+    void SetSpoolFile(const G4String &fileName) { fSpoolFile = fileName; }
+    G4bool IsEnabled() const { return fMaxTime > 0 || fMaxSteps > 0; }
+
+    // the state of one thread, owned by its RunAction
+    class Monitor
+    {
+    public:
+        void BeginOfEvent(G4int eventID);
+        // true once the event has been stopped
+        G4bool Step(const G4Step *step)
+        {
+            if (++fSteps < fNextCheck)
+                return false;
+            return Check(step);
+        }
+        void EndOfEvent();
+        G4bool IsCurrentEventSkipped() const { return fSkipped; }
+
+        const std::vector<G4int> &GetSkippedEvents() const { return fSkippedEvents; }
+        void Merge(const Monitor &other);
+        void Print() const;
+
+    private:
+        friend class EventWatchdog;
+        // the clock is read every this many steps
+        static constexpr G4long kTimeCheckSteps = 1000;
+        static constexpr G4int kNumTimeBins = 48;  // log2 of the event time in us
+
+        G4bool Check(const G4Step *step);
+        void Trip(const G4Step *step, const char *budget);
+        void SetNextCheck();
+
+        G4double fMaxSeconds{0};
+        G4long fMaxSteps{0};
+        Action fAction{Action::Abort};
+        G4String fSpoolFile;
+
+        G4int fEventID{0};
+        G4long fSteps{0};
+        G4long fNextCheck{LONG_MAX};
+        G4bool fTripped{false};
+        G4bool fSkipped{false};
+        std::chrono::steady_clock::time_point fEventStart;
+
+        std::vector<G4int> fSkippedEvents;
+        G4long fNumEvents{0};
+        G4long fTimeBins[kNumTimeBins]{};
+        G4double fTotalSeconds{0};
+        G4double fSlowestSeconds{0};
+        G4int fSlowestEvent{-1};
+    };
+
+    // nullptr without a budget
+    std::unique_ptr<Monitor> CreateMonitor() const;
+
+private:
+    EventWatchdog();
+
+    G4double fMaxTime{0};   // 0 = no budget
+    G4long fMaxSteps{0};
+    Action fAction{Action::Abort};
+    G4String fSpoolFile{"skipped_events.txt"};
+    EventWatchdogMessenger *fMessenger;
+};
@@ -0,0 +1,55 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NavigationBenchmark.hh
+/// \brief Definition of the NavigationBenchmark class
+
+#pragma once
+#include "globals.hh"
+
+class DetectorConstruction;
+class G4VPhysicalVolume;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Times the navigator alone on the current geometry, without physics.
+// Straight rays start at random points in the voxel lattice bounding box
+// and are stepped from boundary to boundary (ComputeStep followed by
+// LocateGlobalPointAndSetup) until they leave the box, as transport does
+// for a particle that never interacts. Run it for each /det/layout and
+// lattice size to compare the flat and hierarchical layouts.
+
+class NavigationBenchmark
+{
+public:
+    struct Result
+    {
+        G4long numSteps{0};
+        G4double seconds{0};
+    };
+
+    static Result Run(G4VPhysicalVolume *world, const DetectorConstruction &detector, G4int numRays);
+};
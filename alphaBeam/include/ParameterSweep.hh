@@ -0,0 +1,81 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ParameterSweep.hh
+/// \brief Definition of the ParameterSweep class
+
+#pragma once
+#include "globals.hh"
+#include <utility>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Runs many detector configurations in one process. Each configuration is
+// applied with the /det/ commands, which rebuild the geometry in place, and
+// then run with BeamOn; physics tables are built once and reused, only the
+// geometry and the couple table are updated between runs.
+//
+// The sweep file is either a grid, one parameter per line followed by its
+// values and an optional unit, of which the Cartesian product is run:
+//     spacing 0.5 1 2 um
+//     ndiv_Z 50 100
+// or a list, one configuration per line; parameters a line does not set
+// keep the value they had before it:
+//     spacing=0.5um ndiv_Z=100
+//     spacing=1um startZ=50um
+// Parameters are spacing, startZ, ndiv_X, ndiv_Y, ndiv_Z and layout, lengths
+// default to um. An "events N" line sets the events per configuration.
+//
+// Output files of each run are tagged with the configuration, e.g.
+// output_spacing0.5um_ndiv_Z100.root.
+
+class ParameterSweep
+{
+public:
+    explicit ParameterSweep(const G4String &fileName);
+
+    void Run();
+
+    G4int GetNumberOfConfigurations() const { return (G4int)fConfigurations.size(); }
+
+    // tag of the configuration being run, empty outside a sweep
+    static const G4String &GetCurrentTag() { return fgCurrentTag; }
+
+private:
+    // (parameter, value with unit)
+    using Setting = std::pair<G4String, G4String>;
+    using Configuration = std::vector<Setting>;
+
+    static G4String GetCommand(const G4String &parameter);
+    static G4String FormatValue(const G4String &parameter, const G4String &number, const G4String &unit);
+    static G4String MakeTag(const Configuration &configuration);
+
+    std::vector<Configuration> fConfigurations;
+    G4int fNumEvents{1000};
+
+    static G4String fgCurrentTag;
+};
@@ -0,0 +1,85 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+//
+/// \file ParticleSpecies.hh
+/// \brief Definition of the ParticleSpecies class
+
+#pragma once
+#include "globals.hh"
+#include <map>
+#include <unordered_map>
+
+class G4ParticleDefinition;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// The particleID of the records, a class of species:
+//   1 e-, 2 gamma, 3 alpha, 4 proton  (what the DNA stage transports)
+//   5 ion    any other nucleus: recoils, d, t, He3, ...
+//   6 other  anything else: neutrinos, e+, neutrons, ...
+// Records also carry the PDG code (100ZZZAAAI for nuclei), which names the
+// species exactly. -species selects the classes that are recorded,
+// e-,gamma,alpha,proton by default.
+//
+// The species reaching a voxel but not recorded are counted per thread,
+// merged at the end of the run and printed by the master, in place of a
+// line per occurrence.
+
+class ParticleSpecies
+{
+public:
+    enum ID { kElectron = 1, kGamma, kAlpha, kProton, kIon, kOther, kNumIDs };
+    static const G4int kDefaultMask = 1 << kElectron | 1 << kGamma | 1 << kAlpha | 1 << kProton;
+
+    static G4int GetID(const G4ParticleDefinition *particle);
+    static const char *GetName(G4int id);
+    // 0 if name is not a class
+    static G4int FindID(const G4String &name);
+    // comma-separated class names or "all", bit n for particleID n
+    static G4int ParseMask(const G4String &names);
+    // the -species mask
+    static G4int GetRecordedMask();
+
+    void Reset() { fSkipped.clear(); }
+    // a voxel entry (or a decay product in a voxel, created) not recorded
+    void CountSkipped(const G4ParticleDefinition *particle, G4bool created)
+    {
+        Counts &counts = fSkipped[particle];
+        ++(created ? counts.created : counts.entering);
+    }
+    void Merge(const ParticleSpecies &other);
+    void Print() const;
+
+private:
+    struct Counts
+    {
+        G4long entering{0};
+        G4long created{0};
+    };
+    // particle definitions are shared by all threads
+    std::unordered_map<const G4ParticleDefinition *, Counts> fSkipped;
+};
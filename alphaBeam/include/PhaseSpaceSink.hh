@@ -0,0 +1,65 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhaseSpaceSink.hh
+/// \brief Definition of the PhaseSpaceSink class
+
+#pragma once
+#include "globals.hh"
+#include <cstddef>
+#include <memory>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Byte destination of the phase-space output, chosen from the -out option:
+//   name           - regular file name.bin
+//   fifo:path      - named pipe, created if missing
+//   unix:path      - Unix domain socket, a consumer must be listening
+//   stdout:        - standard output; G4cout is moved to stderr at start-up
+// Writes to pipes and sockets block while the consumer is behind, which is
+// the backpressure on transport. Stream targets carry framed batches, see
+// PhaseSpaceWriter.
+
+class PhaseSpaceSink
+{
+public:
+    virtual ~PhaseSpaceSink() = default;
+
+    static std::unique_ptr<PhaseSpaceSink> Create(const G4String &target);
+
+    // true for fifo:, unix: and stdout: targets
+    static G4bool IsStream(const G4String &target);
+
+    // must be called before anything is printed when streaming to stdout
+    static void ReserveStdout();
+
+    virtual G4bool Write(const void *data, std::size_t size) = 0;
+    virtual void Close() = 0;
+    virtual const G4String &GetName() const = 0;
+
+private:
+    static int fgStdoutFd;
+};
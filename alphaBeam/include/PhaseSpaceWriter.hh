@@ -0,0 +1,129 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhaseSpaceWriter.hh
+/// \brief Definition of the PhaseSpaceWriter class
+
+#pragma once
+#include "globals.hh"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct VoxelEntryRecord;
+class CompactRecordCodec;
+class PhaseSpaceSink;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Writes the phase-space (.bin) file read by the DNA simulation.
+// Selected with -psformat:
+//   float        - 12 floats (48 bytes) per record, no header (default)
+//   compact      - quantised records, see CompactRecordCodec
+//   compact-zlib - compact records, each block zlib compressed
+// Optional fields follow the record, in this order:
+//   -lineage  trackID, parentID and entry (the number of voxel entries of
+//             the track before this one)
+//   -psvoxel  the voxel's lattice indices i and j (copyNo is k), needed by
+//             psSort
+//   species   with -species ion or other: the PDG code, 0 for nuclei, then
+//             Z and A of nuclei, 0 otherwise (float cannot hold 100ZZZAAAI)
+// as floats in the float format (up to 20 floats, 80 bytes), as in
+// CompactRecordCodec in the compact format.
+// Compact files start with a 16-byte header, char[8] "ABPSC001", uint32
+// flags (bit 0: zlib, bit 1: lineage, bit 2: voxel, bit 3: species) and
+// float voxel half-size [mm], followed by blocks of uint32 numRecords,
+// uint32 rawBytes, uint32 storedBytes and the payload.
+//
+// Stream targets (fifo:, unix:, stdout:, see PhaseSpaceSink) carry frames of
+// uint32 type, uint32 length and the payload:
+//   1 header        char[8] "ABPSS001", uint32 format (0 float, 1 compact,
+//                   2 compact-zlib; +256 with lineage, +512 with voxel,
+//                   +1024 with species),
+//                   float voxel half-size [mm]
+//   2 batch         float records, or one compact block as in the file
+//   3 end of event  int32 eventID, sent after the event's batches
+//   4 end of stream no payload
+// A batch never spans two events, so a consumer can finish an event as soon
+// as its end-of-event frame arrives.
+
+class PhaseSpaceWriter
+{
+public:
+    enum class Format
+    {
+        Float,
+        Compact,
+        CompactZlib
+    };
+
+    // optional fields, see above
+    enum Field : std::uint32_t
+    {
+        kLineage = 1,
+        kVoxel = 2,
+        kSpecies = 4
+    };
+
+    PhaseSpaceWriter(Format format, G4double voxelHalfSize, std::uint32_t fields = 0);
+    ~PhaseSpaceWriter();
+
+    static Format ParseFormat(const G4String &name);
+
+    G4bool Open(const G4String &target);
+    void Write(const VoxelEntryRecord &record);
+    void EndOfEvent(G4int eventID);
+    void Close();
+
+    G4long GetBytesWritten() const { return fBytesWritten; }
+
+private:
+    enum FrameType : std::uint32_t
+    {
+        kHeaderFrame = 1,
+        kBatchFrame = 2,
+        kEndOfEventFrame = 3,
+        kEndOfStreamFrame = 4
+    };
+
+    void FlushBlock();
+    void WriteFrame(FrameType type, const void *payload, std::uint32_t size);
+
+    Format fFormat;
+    G4double fVoxelHalfSize;
+    std::uint32_t fFields;
+    std::unique_ptr<PhaseSpaceSink> fSink;
+    G4bool fFramed{false};
+
+    std::unique_ptr<CompactRecordCodec> fCodec;
+    std::vector<std::uint8_t> fBlock;
+    std::vector<std::uint8_t> fCompressed;
+    std::size_t fBlockSize{0};
+    std::uint32_t fBlockRecords{0};
+
+    G4long fNumRecords{0};
+    G4long fBytesWritten{0};
+};
@@ -30,12 +30,22 @@
 #pragma once
 #include "G4VUserPrimaryGeneratorAction.hh"
 #include <memory>
+#include <vector>
 #include "G4ThreeVector.hh"
 
 #include "G4ParticleGun.hh"
 
 
 class G4GeneralParticleSource;
+class PrimaryGeneratorMessenger;
+
+// Particle gun placed on a point, line, cylinder-surface or volume source
+// (/source/ commands). Vertices are sampled in batches from one flatArray()
+// call; a batch never spans events, which are seeded one by one (EventSeed).
+// With /source/restrictToLattice, vertices are kept in proportion to the cone
+// enclosing the voxel lattice from them, and directions are drawn inside that
+// cone and rejected unless they hit it, so kept primaries follow the 4pi source
+// restricted to the lattice; that fraction of 4pi is the geometric efficiency.
 
 class PrimaryGeneratorAction
     : public G4VUserPrimaryGeneratorAction
@@ -45,9 +55,58 @@ public:
     ~PrimaryGeneratorAction() override;
     void GeneratePrimaries(G4Event *event) override;
 
+    enum class SourceType { Point, Line, Cylinder, Volume };
+    enum class DepthProfile { None, Uniform, Exponential };
+
+    void SetSourceType(const G4String &type);
+    void SetCentre(const G4ThreeVector &centre) { fCentre = centre; fNextVertex = fVertices.size(); }
+    void SetLength(G4double length) { fLength = length; fNextVertex = fVertices.size(); }
+    void SetRadius(G4double radius) { fRadius = radius; fNextVertex = fVertices.size(); }
+    void SetDepthProfile(const G4String &profile);
+    void SetDepth(G4double depth) { fDepth = depth; fNextVertex = fVertices.size(); }
+    void LoadSpectrum(const G4String &fileName);
+    void SetIsotropic(G4bool value) { fIsotropic = value; }
+    void SetRestrictToLattice(G4bool value) { fRestrictToLattice = value; }
+    void SetBatchSize(G4int size) { fBatchSize = size; fNextVertex = fVertices.size(); }
+
+    void ResetCounters();
+    G4long GetNumberOfTries() const { return fNumTries; }
+    // fraction of isotropic emissions reaching the lattice (1 if not restricted)
+    G4double GetGeometricEfficiency() const;
+
 private:
+    G4ThreeVector NextVertex();
+    void FillVertexBatch();
+    G4double SampleEnergy() const;
+    G4ThreeVector SampleTowardsLattice(G4ThreeVector &vertex);
+
     G4ParticleGun*  fParticleGun;  
     G4int numParticles{0};
 
+    PrimaryGeneratorMessenger* fMessenger;
+
+    SourceType fType{SourceType::Point};
+    DepthProfile fDepthProfile{DepthProfile::None};
+    G4ThreeVector fCentre;
+    G4double fLength{0};
+    G4double fRadius{0};
+    G4double fDepth{0};
+    G4bool fIsotropic{false};
+    G4bool fRestrictToLattice{false};
+
+    G4int fBatchSize{4096};    // largest batch
+    std::size_t fNextBatch{1}; // size of the next batch, doubles within an event
+    std::vector<G4double> fRandom;
+    std::vector<G4ThreeVector> fVertices;
+    std::size_t fNextVertex{0};
+
+    std::vector<G4double> fLineEnergies;
+    std::vector<G4double> fLineCDF;
+
+    // -replay event list, and how many of it this run has done
+    std::vector<G4int> fReplayEvents;
+    std::size_t fReplayIndex{0};
 
+    G4long fNumTries{0};
+    G4double fSumHitSolidAngle{0};
 };
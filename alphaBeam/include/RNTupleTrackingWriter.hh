@@ -0,0 +1,64 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RNTupleTrackingWriter.hh
+/// \brief Definition of the RNTupleTrackingWriter class
+
+#pragma once
+#include "TrackingDataWriter.hh"
+#include <cstdint>
+
+#ifdef ALPHABEAM_WITH_RNTUPLE
+
+class TFile;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// RNTuple backend: TrackingData is written as an RNTuple with the same
+// narrow columns as the TTree backend; Info stays a one-entry TTree in the
+// same file. ROOT headers are kept out of this header, the writer and the
+// field pointers live in the implementation.
+
+class RNTupleTrackingWriter : public TrackingDataWriter
+{
+public:
+    explicit RNTupleTrackingWriter(G4int compression);
+    ~RNTupleTrackingWriter() override;
+
+    G4bool Open(const G4String &fileName) override;
+    void Fill(const VoxelEntryRecord &record) override;
+    void Close(const RunInfo &info) override;
+
+private:
+    struct Columns;
+
+    G4int fCompression;
+    G4String fFileName;
+    TFile *fFile{nullptr};
+    Columns *fColumns{nullptr};
+};
+
+#endif
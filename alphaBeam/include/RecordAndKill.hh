@@ -0,0 +1,136 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+//
+/// \file RecordAndKill.hh
+/// \brief Definition of the RecordAndKill class
+
+#pragma once
+#include "globals.hh"
+#include "ParticleSpecies.hh"
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+
+class G4Step;
+class RecordAndKillMessenger;
+struct VoxelEntryRecord;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Stops particles once they are recorded at a voxel, as the DNA stage
+// re-tracks them from the record anyway. Set with /kill/:
+//     /kill/particles e- alpha       particles to stop ("none": off, the default)
+//     /kill/maxRange 340 nm          residual range limit, 0 for the voxel pitch
+//     /kill/maxEnergy gamma 10 keV   energy limit, instead of the range one
+//     /kill/dryRun true              only measure what killing would change
+// A particle is stopped when its kinetic energy is below the energy whose
+// range in the voxel material is the range limit, so it could not have
+// crossed into another voxel. Gammas have no range and need /kill/maxEnergy.
+// Entering particles are stopped on the boundary, keeping the secondaries
+// of the step in the water; radioactive-decay products recorded where they
+// were created in a voxel are stopped with the secondaries of their first
+// step, which the DNA stage regenerates.
+//
+// The dry run stops nothing and instead times the steps of the tracks that
+// would have been stopped, and of their descendants, after the stopping
+// point, and counts the records they write: the CPU that killing saves and
+// the records it removes.
+
+class RecordAndKill
+{
+public:
+    static RecordAndKill *Instance();
+    ~RecordAndKill();
+
+    void SetParticles(const G4String &names);
+    void SetMaxRange(G4double range) { fMaxRange = range; }
+    void SetMaxEnergy(const G4String &particle, G4double energy);
+    void SetDryRun(G4bool dryRun) { fDryRun = dryRun; }
+    G4bool IsEnabled() const { return fParticleMask != 0; }
+
+    // the state of one thread, owned by its RunAction
+    class Policy
+    {
+    public:
+        // every step, before anything is recorded
+        void Step(const G4Step *step)
+        {
+            if (fDryRun)
+                Shadow(step);
+        }
+        // after a record is written for the step's track; true if the
+        // track is to be stopped
+        G4bool Kill(const VoxelEntryRecord &record, const G4Step *step, G4bool withSecondaries);
+        void CountRecord()
+        {
+            if (fShadowed)
+                fShadowRecords++;
+        }
+        void EndOfEvent();
+
+        void Merge(const Policy &other);
+        void Print() const;
+
+    private:
+        friend class RecordAndKill;
+        static constexpr G4int kNumParticles = ParticleSpecies::kNumIDs; // by particleID
+
+        void Shadow(const G4Step *step);
+
+        G4double fMaxEnergy[kNumParticles]{};  // 0: not stopped
+        G4bool fDryRun{false};
+
+        G4long fKilled[kNumParticles]{};
+        G4double fKilledEnergy[kNumParticles]{};
+
+        // dry run: the track being stepped is past a stopping point, or
+        // descends from one. Tracks are keyed by ID, as G4Allocator reuses
+        // their addresses; the value is the global time after which the
+        // track's secondaries are shadowed too.
+        G4bool fShadowed{false};
+        G4int fTrackID{0};
+        std::unordered_map<G4int, G4double> fShadowTracks;
+        std::chrono::steady_clock::time_point fLastStep;
+        G4double fStepSeconds{0};
+        G4double fShadowSeconds{0};
+        G4long fSteps{0};
+        G4long fShadowSteps{0};
+        G4long fShadowRecords{0};
+    };
+
+    // nullptr if off; voxelPitch is the default range limit
+    std::unique_ptr<Policy> Compile(G4double voxelPitch) const;
+
+private:
+    RecordAndKill();
+
+    G4int fParticleMask{0};
+    G4double fMaxRange{0};
+    G4double fMaxEnergy[Policy::kNumParticles]{};
+    G4bool fDryRun{false};
+    RecordAndKillMessenger *fMessenger;
+};
@@ -0,0 +1,106 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RecordConsumer.hh
+/// \brief Definition of the RecordConsumer plugin interface
+
+#pragma once
+#include "globals.hh"
+#include "VoxelEntryRecord.hh"
+#include <cstddef>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// In-process consumer of voxel-entry records, loaded from a shared library
+// with -consumer lib.so[:args]. The library defines a RecordConsumer
+// subclass and exports it with
+//
+//     ALPHABEAM_RECORD_CONSUMER(MyConsumer)
+//
+// which requires a MyConsumer(const char *args) constructor; args is the
+// text after the ':' (empty if none).
+//
+// Every thread that processes events gets its own instance, so consumers
+// need no locking. Per run, each worker instance sees
+//     BeginOfRun, { ProcessRecords..., EndOfEvent }..., EndOfRun
+// and is then merged into the master instance, whose EndOfRun comes after
+// all workers have been merged. In a serial run the single instance is
+// the master and nothing is merged. An event's records arrive just before
+// its EndOfEvent, in spans of up to 1024 records; a span is only valid
+// during the call.
+//
+// Bump ALPHABEAM_CONSUMER_API_VERSION whenever this header or
+// VoxelEntryRecord changes layout; libraries built against another version
+// are refused.
+
+#define ALPHABEAM_CONSUMER_API_VERSION 4
+
+struct RecordSpan
+{
+    const VoxelEntryRecord *data{nullptr};
+    std::size_t size{0};
+
+    const VoxelEntryRecord *begin() const { return data; }
+    const VoxelEntryRecord *end() const { return data + size; }
+    const VoxelEntryRecord &operator[](std::size_t i) const { return data[i]; }
+    bool empty() const { return size == 0; }
+};
+
+struct ConsumerRunInfo
+{
+    G4int runID{0};
+    G4int threadID{-1};          // -1 for the master
+    G4bool isMaster{true};
+    G4int ndiv_X{0};
+    G4int ndiv_Y{0};
+    G4int ndiv_Z{0};             // voxel copyNo is the Z layer index
+    G4double spacing{0};
+    G4double voxelHalfSize{0};
+    const char *outputBaseName{""}; // -out name without extension, plus the sweep tag
+};
+
+class RecordConsumer
+{
+public:
+    virtual ~RecordConsumer() = default;
+
+    virtual void BeginOfRun(const ConsumerRunInfo &) {}
+    virtual void ProcessRecords(RecordSpan records) = 0;
+    virtual void EndOfEvent(G4int /*eventID*/) {}
+    virtual void EndOfRun(G4int /*numEvents*/) {}
+    // called on the master instance with each worker's, same library
+    virtual void Merge(RecordConsumer & /*worker*/) {}
+};
+
+// entry points looked up by RecordConsumerSet
+extern "C" typedef int (*RecordConsumerVersionFunction)();
+extern "C" typedef RecordConsumer *(*RecordConsumerCreateFunction)(const char *args);
+extern "C" typedef void (*RecordConsumerDestroyFunction)(RecordConsumer *);
+
+#define ALPHABEAM_RECORD_CONSUMER(ClassName)                                                      \
+    extern "C" int alphaBeamConsumerApiVersion() { return ALPHABEAM_CONSUMER_API_VERSION; }       \
+    extern "C" RecordConsumer *alphaBeamCreateConsumer(const char *args) { return new ClassName(args); } \
+    extern "C" void alphaBeamDestroyConsumer(RecordConsumer *consumer) { delete consumer; }
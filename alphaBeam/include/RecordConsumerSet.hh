@@ -0,0 +1,75 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RecordConsumerSet.hh
+/// \brief Definition of the RecordConsumerSet class
+
+#pragma once
+#include "globals.hh"
+#include "RecordConsumer.hh"
+#include "EventArena.hh"
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// The consumer libraries given with -consumer, and one thread's instances
+// of them (owned by that thread's RunAction). An event's records are kept
+// in blocks taken from the thread's EventArena and handed to every consumer
+// at the end of the event, one span per block.
+
+class RecordConsumerSet
+{
+public:
+    // -consumer lib.so[:args][,lib2.so[:args]...], on the master before any run
+    static void LoadLibraries(const G4String &spec);
+    static G4bool HasLibraries();
+
+    explicit RecordConsumerSet(EventArena &arena);
+    ~RecordConsumerSet();
+
+    void BeginOfRun(const ConsumerRunInfo &info);
+    void Add(const VoxelEntryRecord &record)
+    {
+        if (fBlockSize == kBlockCapacity || fBlock == nullptr)
+            NewBlock();
+        new (fBlock + fBlockSize++) VoxelEntryRecord(record);
+    }
+    // hands over the records; must come before the arena is reset
+    void Flush();
+    void EndOfEvent(G4int eventID);
+    void EndOfRun(G4int numEvents);
+    void Merge(RecordConsumerSet &worker);
+
+private:
+    static constexpr std::size_t kBlockCapacity = 1024;
+    void NewBlock();
+
+    std::vector<RecordConsumer *> fConsumers; // one per library, in -consumer order
+    EventArena &fArena;
+    std::vector<RecordSpan> fBlocks;          // full blocks of this event
+    VoxelEntryRecord *fBlock{nullptr};        // block being filled
+    std::size_t fBlockSize{0};
+};
@@ -0,0 +1,157 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RecordFilter.hh
+/// \brief Definition of the RecordFilter class
+
+#pragma once
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+#include <cfloat>
+#include <climits>
+#include <memory>
+#include <vector>
+
+class G4VProcess;
+class RecordFilterMessenger;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Rules deciding which voxel entries are written, set with /filter/:
+//     /filter/rule reject particle=gamma
+//     /filter/rule reject particle=e- ekin=:10eV
+//     /filter/rule accept copyNo=40:60 cone=0,0,1:30
+//     /filter/default reject
+// A rule matches when all its conditions do:
+//     particle=e-,gamma,alpha,proton    (the ParticleSpecies classes, also ion, other)
+//     ekin=min:max                      value[unit], MeV by default, either side optional
+//     copyNo=min:max                    inclusive
+//     cone=x,y,z:angle                  direction within angle [deg] of the axis
+//     creator=name,...                  creator process; "primary" for primaries
+// Rules are tried in order and the first match accepts or rejects the
+// record; if none matches the default (accept) applies.
+//
+// At the start of each run every thread compiles the rules into a
+// Predicate: particle masks, cosines and the creator processes' pointers,
+// so the test before a record is built involves no strings or trig.
+
+class RecordFilter
+{
+public:
+    static RecordFilter *Instance();
+    ~RecordFilter();
+
+    void AddRule(const G4String &spec);
+    void SetDefault(G4bool accept) { fDefaultAccept = accept; }
+    void Clear() { fRules.clear(); fDefaultAccept = true; }
+    void List() const;
+    G4bool IsEmpty() const { return fRules.empty() && fDefaultAccept; }
+
+    class Predicate
+    {
+    public:
+        G4bool Accept(G4int particleID, G4double kineticEnergy, G4int copyNo,
+                      const G4ThreeVector &direction, const G4VProcess *creator);
+        void Merge(const Predicate &other);
+        void Print() const;
+
+    private:
+        friend class RecordFilter;
+        struct Rule
+        {
+            G4String text;
+            G4bool accept;
+            G4int particleMask;      // bit n for particleID n, 0 for any
+            G4double minEnergy, maxEnergy;
+            G4int minCopyNo, maxCopyNo;
+            G4bool hasCone;
+            G4ThreeVector axis;
+            G4double minCos;
+            G4bool hasCreator;
+            G4bool primary;          // creator list includes "primary"
+            std::vector<const G4VProcess *> creators;
+            G4long matched;
+        };
+        std::vector<Rule> fRules;
+        G4bool fDefaultAccept{true};
+        G4long fDefaultMatched{0};
+    };
+
+    // for the calling thread, whose process objects it refers to
+    std::unique_ptr<Predicate> Compile() const;
+
+private:
+    RecordFilter();
+
+    struct RuleSpec
+    {
+        G4String text;
+        G4bool accept{true};
+        G4int particleMask{0};
+        G4double minEnergy{0};
+        G4double maxEnergy{DBL_MAX};
+        G4int minCopyNo{INT_MIN};
+        G4int maxCopyNo{INT_MAX};
+        G4bool hasCone{false};
+        G4ThreeVector axis;
+        G4double minCos{-1};
+        std::vector<G4String> creators;
+    };
+
+    std::vector<RuleSpec> fRules;
+    G4bool fDefaultAccept{true};
+    RecordFilterMessenger *fMessenger;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+inline G4bool RecordFilter::Predicate::Accept(G4int particleID, G4double kineticEnergy, G4int copyNo,
+                                              const G4ThreeVector &direction, const G4VProcess *creator)
+{
+  for (Rule &rule : fRules)
+  {
+    if (rule.particleMask != 0 && !(rule.particleMask & (1 << particleID)))
+      continue;
+    if (kineticEnergy < rule.minEnergy || kineticEnergy > rule.maxEnergy)
+      continue;
+    if (copyNo < rule.minCopyNo || copyNo > rule.maxCopyNo)
+      continue;
+    if (rule.hasCone && direction.dot(rule.axis) < rule.minCos)
+      continue;
+    if (rule.hasCreator)
+    {
+      G4bool found = creator == nullptr ? rule.primary : false;
+      for (const G4VProcess *process : rule.creators)
+        found |= (process == creator);
+      if (!found)
+        continue;
+    }
+    rule.matched++;
+    return rule.accept;
+  }
+  fDefaultMatched++;
+  return fDefaultAccept;
+}
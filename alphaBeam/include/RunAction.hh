@@ -28,7 +28,19 @@
 #include "G4UserRunAction.hh"
 #include "G4String.hh"
 #include <vector>
+#include <memory>
+#include <chrono>
+#include "StepStatistics.hh"
+#include "ParticleSpecies.hh"
+#include "RecordFilter.hh"
+#include "EventArena.hh"
+#include "EventWatchdog.hh"
+#include "RecordAndKill.hh"
 class DetectorConstruction;
+class VoxelScorer;
+class TrackingDataWriter;
+class PhaseSpaceWriter;
+class RecordConsumerSet;
 
 
 class G4Run;
@@ -44,14 +56,65 @@ public:
     void BeginOfRunAction(const G4Run*) override;
     void EndOfRunAction(const G4Run*) override;
     
+    // shells of the radial placement, set at the start of each run
     void setRmin(G4double min) {Rmin = min;}
     void setRmax(G4double max) {Rmax = max;}
 
     void setNumCells(G4int numCells) {NumCells.push_back(numCells); }
 
+    VoxelScorer* GetVoxelScorer() { return fVoxelScorer.get(); }
+    TrackingDataWriter* GetTrackingWriter() { return fTrackingWriter.get(); }
+    PhaseSpaceWriter* GetPhaseSpaceWriter() { return fPhaseSpaceWriter.get(); }
+    StepStatistics& GetStepStatistics() { return fStepStatistics; }
+    // skipped species, see ParticleSpecies
+    ParticleSpecies& GetParticleSpecies() { return fParticleSpecies; }
+    RecordFilter::Predicate* GetRecordFilter() { return fRecordFilter.get(); }
+    RecordConsumerSet* GetRecordConsumers() { return fRecordConsumers.get(); }
+    EventWatchdog::Monitor* GetWatchdog() { return fWatchdog.get(); }
+    RecordAndKill::Policy* GetRecordAndKill() { return fRecordAndKill.get(); }
+    // memory for objects of the current event, released by EventAction
+    EventArena& GetEventArena() { return fEventArena; }
+
+    // busy time of this thread, from EventAction
+    void BeginOfEvent() { fEventStart = std::chrono::steady_clock::now(); }
+    void EndOfEvent() { fBusyTime += std::chrono::steady_clock::now() - fEventStart; }
+
 private:
     void Write(const G4Run*);
+    void WriteVoxelScores(const G4Run*);
     G4double Rmin{0};
     G4double Rmax{0};
     std::vector<G4int> NumCells;
+    std::unique_ptr<VoxelScorer> fVoxelScorer;
+    std::unique_ptr<TrackingDataWriter> fTrackingWriter;
+    std::unique_ptr<PhaseSpaceWriter> fPhaseSpaceWriter;
+    StepStatistics fStepStatistics;
+    ParticleSpecies fParticleSpecies;
+    std::unique_ptr<RecordFilter::Predicate> fRecordFilter;
+    std::unique_ptr<EventWatchdog::Monitor> fWatchdog;
+    std::unique_ptr<RecordAndKill::Policy> fRecordAndKill;
+    EventArena fEventArena;
+    std::unique_ptr<RecordConsumerSet> fRecordConsumers;
+    void BeginConsumers(const G4Run*);
+    void OpenPhaseSpaceWriter(const G4String& option);
+    G4String GetOutputBaseName(const G4String& defaultName) const;
+    G4String fPhaseSpaceTag;
+
+    // In MT runs the master RunAction (BuildForMaster) only collects: each
+    // worker merges its step counts and load into it at end of run.
+    struct ThreadLoad
+    {
+        G4int threadID;
+        G4int numEvents;
+        G4double busySeconds;
+        G4double wallSeconds;
+    };
+    G4bool ProcessesEvents() const;
+    void MergeIntoMaster(const G4Run*);
+    void PrintThreadLoads() const;
+    std::chrono::steady_clock::time_point fRunStart;
+    std::chrono::steady_clock::time_point fEventStart;
+    std::chrono::duration<G4double> fBusyTime{0};
+    std::vector<ThreadLoad> fThreadLoads;
+    static RunAction *fgMasterInstance;
 };
@@ -0,0 +1,136 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+//
+/// \file SpatialHash.hh
+/// \brief Definition of the SpatialHash class
+
+#pragma once
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Hash of a uniform grid of cubic cells, each holding at most one object
+// index; the cell size is chosen so that two valid objects never share a
+// cell (see CellPacking). Open addressing with linear probing, so a lookup
+// is a multiply and usually one cache line. Cell indices must stay within
+// +-2^20 per axis.
+
+class SpatialHash
+{
+public:
+    void Reset(G4double cellSize, std::size_t maxObjects)
+    {
+        fCellSize = cellSize;
+        std::size_t capacity = 16;
+        fShift = 60;
+        while (capacity < 2 * maxObjects)
+        {
+            capacity *= 2;
+            fShift--;
+        }
+        fKeys.assign(capacity, 0);
+        fValues.assign(capacity, -1);
+        fMask = capacity - 1;
+    }
+
+    G4double GetCellSize() const { return fCellSize; }
+
+    // false if the cell of p is taken
+    G4bool Insert(const G4ThreeVector &p, G4int value)
+    {
+        std::uint64_t key = Key(Cell(p.x()), Cell(p.y()), Cell(p.z()));
+        for (std::size_t slot = Slot(key);; slot = (slot + 1) & fMask)
+        {
+            if (fKeys[slot] == key)
+                return false;
+            if (fKeys[slot] == 0)
+            {
+                fKeys[slot] = key;
+                fValues[slot] = value;
+                return true;
+            }
+        }
+    }
+
+    // calls f(value) for the objects in the cells up to reach cells away
+    // from the cell of p along each axis
+    template <typename Function>
+    void ForEachNear(const G4ThreeVector &p, G4int reach, Function f) const
+    {
+        if (fKeys.empty())
+            return;
+        std::int64_t x = Cell(p.x());
+        std::int64_t y = Cell(p.y());
+        std::int64_t z = Cell(p.z());
+        for (std::int64_t dx = -reach; dx <= reach; dx++)
+            for (std::int64_t dy = -reach; dy <= reach; dy++)
+                for (std::int64_t dz = -reach; dz <= reach; dz++)
+                {
+                    G4int value = Find(Key(x + dx, y + dy, z + dz));
+                    if (value >= 0)
+                        f(value);
+                }
+    }
+
+private:
+    std::int64_t Cell(G4double x) const { return (std::int64_t)std::floor(x / fCellSize); }
+
+    // 21 bits per axis, never 0, which marks an empty slot
+    static std::uint64_t Key(std::int64_t x, std::int64_t y, std::int64_t z)
+    {
+        const std::int64_t offset = 1 << 20;
+        const std::uint64_t mask = (1 << 21) - 1;
+        return (((std::uint64_t)(x + offset) & mask) << 42 | ((std::uint64_t)(y + offset) & mask) << 21 |
+                ((std::uint64_t)(z + offset) & mask)) + 1;
+    }
+
+    std::size_t Slot(std::uint64_t key) const
+    {
+        return (std::size_t)((key * 0x9E3779B97F4A7C15ull) >> fShift) & fMask;
+    }
+
+    G4int Find(std::uint64_t key) const
+    {
+        for (std::size_t slot = Slot(key);; slot = (slot + 1) & fMask)
+        {
+            if (fKeys[slot] == key)
+                return fValues[slot];
+            if (fKeys[slot] == 0)
+                return -1;
+        }
+    }
+
+    G4double fCellSize{1};
+    std::vector<std::uint64_t> fKeys;
+    std::vector<G4int> fValues;
+    std::size_t fMask{0};
+    G4int fShift{60};
+};
@@ -0,0 +1,65 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StepStatistics.hh
+/// \brief Definition of the StepStatistics class
+
+#pragma once
+#include "globals.hh"
+#include "G4VProcess.hh"
+#include "G4TransportationProcessType.hh"
+#include "DetectorConstruction.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Step counts per volume class, to show what the /det/limits/ settings cost.
+// Besides all steps it counts the steps cut short by the step limiter and
+// the tracks killed by the special cuts (min. energy, max. length or time).
+
+class StepStatistics
+{
+public:
+    void Reset();
+
+    void Count(DetectorConstruction::VolumeClass volumeClass, const G4VProcess *limitingProcess)
+    {
+        ++fSteps[volumeClass];
+        if (limitingProcess == nullptr || limitingProcess->GetProcessType() != fGeneral)
+            return;
+        if (limitingProcess->GetProcessSubType() == STEP_LIMITER)
+            ++fLimitedSteps[volumeClass];
+        else if (limitingProcess->GetProcessSubType() == USER_SPECIAL_CUTS)
+            ++fKilledTracks[volumeClass];
+    }
+
+    void Merge(const StepStatistics &other);
+    void Print(const DetectorConstruction &detector, G4int numEvents) const;
+
+private:
+    G4long fSteps[DetectorConstruction::kNumVolumeClasses]{};
+    G4long fLimitedSteps[DetectorConstruction::kNumVolumeClasses]{};
+    G4long fKilledTracks[DetectorConstruction::kNumVolumeClasses]{};
+};
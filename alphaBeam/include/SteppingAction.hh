@@ -29,27 +29,75 @@
 #include "G4String.hh"
 #include <fstream>
 #include <iostream>
+#include <vector>
 #include "RunAction.hh"
+#include "Telemetry.hh"
 
 class EventAction;
 class RunAction;
+class DetectorConstruction;
+class VoxelScorer;
+class G4StepPoint;
+struct VoxelEntryRecord;
 
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
+// Checks every step for a particle entering a voxel, or created in one by
+// radioactive decay, and records it. The sinks the records go to are fixed
+// for the session by the command line, so Create() returns the
+// SteppingActionFor<Sinks> specialisation for them: without any sink the
+// recording code is not there at all, and sinks left out cost nothing per
+// record. There is no template axis for the direction frame: voxels are
+// placed unrotated, so local and world directions coincide and every
+// specialisation writes the same frame.
+
 class SteppingAction : public G4UserSteppingAction
 {
 public:
-    SteppingAction(/*DetectorConstruction* fpDet*/);
+    // where records go:
+    //   phase space   -out, unless -psformat none
+    //   TrackingData  -out, unless -backend none
+    //   consumers     -consumer
+    enum OutputSink { kPhaseSpaceOutput = 1, kTrackingOutput = 2, kConsumerOutput = 4 };
+    static unsigned GetOutputSinks();
+    static SteppingAction *Create() { return Create(GetOutputSinks()); }
+    static SteppingAction *Create(unsigned sinks);
+
     ~SteppingAction() override;
 
-    void UserSteppingAction(const G4Step* step) override;
+    // -firstentry: record every voxel entry of a track, or only its first
+    // one in each Z layer or in the whole lattice
+    enum FirstEntryMode { kAllEntries, kFirstPerLayer, kFirstPerLattice };
+    static FirstEntryMode ParseFirstEntryMode(const G4String &);
+
+protected:
+    SteppingAction();
+
+    // statistics, scoring and the kills of every step; false if the step
+    // goes no further
+    G4bool BeginStep(const G4Step *step);
+    // finds the recorded steps, at the voxel boundary or on the first step
+    // of a decay product in a voxel
+    template <unsigned Sinks> void RecordStep(const G4Step *step);
+    // records the particle at point: the post-step point of a particle
+    // entering a voxel, the pre-step point of one created in it
+    template <unsigned Sinks, G4bool Created> void RecordAt(const G4Step *step, const G4StepPoint *point);
+    template <unsigned Sinks> void Record(const VoxelEntryRecord &record);
 
-    // void Initialize();
 private:
   EventAction* fpEventAction;
   RunAction *fRunAction;
-  std::ofstream PSfile;
+  const DetectorConstruction *fDetector;
+  Telemetry::Counters *fTelemetry;
 
+  // lineage of the track being stepped, restarted on its first step
+  FirstEntryMode fFirstEntry{kAllEntries};
+  G4int fSpeciesMask{0};   // ParticleSpecies IDs recorded, from -species
+  G4int fTrackEntries{0};
+  G4long fTrackSerial{0};
+  std::vector<G4long> fLayerTrack; // serial of the last track recorded per layer
 
+  void Score(const G4Step *step, VoxelScorer *scorer);
+  G4bool CountEntry(G4int layer);
 };
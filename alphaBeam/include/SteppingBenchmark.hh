@@ -0,0 +1,69 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+//
+/// \file SteppingBenchmark.hh
+/// \brief Definition of the SteppingBenchmark class
+
+#pragma once
+#include "globals.hh"
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Times SteppingAction::UserSteppingAction alone on synthetic steps,
+// without tracking or physics, for the three paths through it:
+//   transport - an electron step inside the water, not recorded
+//   crossing  - an electron step from the water onto a voxel, recorded
+//   decay     - the first step of an electron from radioactive decay in a
+//               voxel, recorded
+// Each step is the first of a new track, so -firstentry never drops it.
+// The steps go through a SteppingAction with every output sink compiled in
+// and the thread's own RunAction (filters, species), so the benchmark runs
+// inside an event: /det/benchmarkStepping N requests it and starts a
+// one-event run, and EventAction runs it at the beginning of that event.
+// No output may be open, nor -score, -telemetry, the watchdog or /kill/,
+// so records are built and dropped and no counter of a real run moves.
+// Heap allocations made meanwhile are counted by the global operator new
+// in SteppingBenchmark.cc. Both only exist in alphaBeamStepBenchmark, built
+// with cmake -DWITH_STEPPING_BENCHMARK=ON.
+
+class SteppingBenchmark
+{
+public:
+    struct Result
+    {
+        const char *name;
+        G4long numSteps{0};
+        G4double seconds{0};
+        G4long allocations{0};
+    };
+
+    static void Request(G4int numSteps);
+    // runs and prints a pending request, on the first thread to get here
+    static void RunIfRequested();
+    static std::vector<Result> Run(G4int numSteps);
+};
@@ -0,0 +1,82 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Telemetry.hh
+/// \brief Definition of the Telemetry class
+
+#pragma once
+#include "globals.hh"
+#include <atomic>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Status file for batch jobs, enabled with -telemetry file[:seconds]. A
+// background thread rewrites the file every interval (10 s by default),
+// through a temporary file and rename() so readers never see half of it:
+// Prometheus text format if the name ends in .prom, JSON otherwise.
+//
+// It reports events done and to do, events/s and steps/s over the last
+// interval, the ETA, records and phase-space bytes written, the resident
+// set size, and how long the longest event still in progress has run.
+//
+// The stepping path only bumps a counter owned by its thread (a relaxed
+// load and store, no read-modify-write or shared cache line); the
+// telemetry thread sums the threads' counters when it writes.
+
+class Telemetry
+{
+public:
+    // a cache line of its own (C++17 aligned new honours the alignment),
+    // so one thread's steps never invalidate another's line
+    struct alignas(64) Counters
+    {
+        std::atomic<G4long> events{0};
+        std::atomic<G4long> steps{0};
+        std::atomic<G4long> records{0};
+        std::atomic<G4long> psBytes{0};       // in the thread's open phase-space file
+        std::atomic<G4long> eventStart{0};    // Now() at BeginOfEvent, 0 between events
+
+        // only ever called by the owning thread
+        static void Add(std::atomic<G4long> &counter, G4long n = 1)
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+        }
+    };
+
+    static void Start(const G4String &spec);
+    // writes the final status and joins the telemetry thread
+    static void Stop();
+
+    // the calling thread's counters, nullptr if telemetry is off
+    static Counters *GetThreadCounters();
+
+    // from the master's RunAction
+    static void BeginOfRun(G4int runID, G4int numEvents);
+    static void EndOfRun();
+
+    // steady clock, ns
+    static G4long Now();
+};
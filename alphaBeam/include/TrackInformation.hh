@@ -0,0 +1,56 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TrackInformation.hh
+/// \brief Definition of the TrackInformation class
+
+#pragma once
+#include "G4VUserTrackInformation.hh"
+#include "globals.hh"
+
+class G4Track;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Carries the ID of the event a track belongs to. In sub-event mode a
+// track may be transported in a sub-event on another thread, whose G4Event
+// has its own ID; records are attributed to the parent event through this.
+// Only attached in sub-event mode, see StackingAction and TrackingAction.
+
+class TrackInformation : public G4VUserTrackInformation
+{
+public:
+    explicit TrackInformation(G4int eventID) : fEventID(eventID) {}
+
+    G4int GetEventID() const { return fEventID; }
+
+    // the parent event of a track: from its information if attached,
+    // otherwise the event being processed
+    static G4int GetEventID(const G4Track *track);
+
+private:
+    G4int fEventID;
+};
@@ -0,0 +1,89 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TrackingDataWriter.hh
+/// \brief Definition of the TrackingDataWriter class
+
+#pragma once
+#include "globals.hh"
+#include <chrono>
+#include <memory>
+#include <vector>
+
+struct VoxelEntryRecord;
+
+// one row of the Info table, written on Close
+struct RunInfo
+{
+    G4int numPrimaries{0};
+    G4String gitHash;
+    G4double geometricEfficiency{1};
+    G4long masterSeed{0};   // with the eventID, gives every event's seeds
+    std::vector<G4int> skippedEvents; // aborted by the watchdog, in this file
+    // radial placement: innermost and outermost shell radius, cells per
+    // shell (copyNo); zero and empty otherwise
+    G4double rMin{0};
+    G4double rMax{0};
+    std::vector<G4int> cellsPerShell;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Backend writing the Info and TrackingData tables of the ROOT output.
+// Selected on the command line with -backend:
+//   g4      - G4AnalysisManager ntuples (default)
+//   tree    - TTree with float columns, explicit basket and compression
+//   rntuple - RNTuple with float columns (ROOT >= 6.30)
+// The ROOT compression setting (algorithm*100 + level, e.g. 505 for zstd 5)
+// is given with -compression.
+
+class TrackingDataWriter
+{
+public:
+    virtual ~TrackingDataWriter() = default;
+
+    static std::unique_ptr<TrackingDataWriter> Create(const G4String &backend,
+                                                      G4int compression);
+
+    virtual G4bool Open(const G4String &fileName) = 0;
+    virtual void Fill(const VoxelEntryRecord &record) = 0;
+    virtual void Close(const RunInfo &info) = 0;
+
+protected:
+    // write timing and throughput, printed on Close
+    void StartTimer() { fStart = std::chrono::steady_clock::now(); }
+    void StopTimer()
+    {
+        fElapsed += std::chrono::steady_clock::now() - fStart;
+    }
+    void PrintThroughput(const G4String &backend, const G4String &fileName) const;
+
+    G4long fNumRecords{0};
+
+private:
+    std::chrono::steady_clock::time_point fStart;
+    std::chrono::duration<G4double> fElapsed{0};
+};
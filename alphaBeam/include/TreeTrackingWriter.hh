@@ -0,0 +1,75 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TreeTrackingWriter.hh
+/// \brief Definition of the TreeTrackingWriter class
+
+#pragma once
+#include "TrackingDataWriter.hh"
+#include <cstdint>
+
+#ifdef ALPHABEAM_WITH_ROOT
+
+class TFile;
+class TTree;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// TTree backend: narrow columns (float for energies and positions, one byte
+// for particleID), explicit basket size, auto-flush and compression.
+
+class TreeTrackingWriter : public TrackingDataWriter
+{
+public:
+    explicit TreeTrackingWriter(G4int compression);
+    ~TreeTrackingWriter() override;
+
+    G4bool Open(const G4String &fileName) override;
+    void Fill(const VoxelEntryRecord &record) override;
+    void Close(const RunInfo &info) override;
+
+private:
+    G4int fCompression;
+    G4String fFileName;
+    TFile *fFile{nullptr};
+    TTree *fTree{nullptr};
+
+    std::int32_t fEventID{0};
+    float fEnergy{0};
+    float fEDep{0};
+    std::uint8_t fParticleID{0};
+    std::int32_t fCopyNo{0};
+    float fPosX{0};
+    float fPosY{0};
+    float fPosZ{0};
+    float fStepLength{0};
+    std::int32_t fTrackID{0};
+    std::int32_t fParentID{0};
+    std::int32_t fEntry{0};
+    std::int32_t fPdg{0};
+};
+
+#endif
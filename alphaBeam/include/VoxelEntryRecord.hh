@@ -0,0 +1,59 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file VoxelEntryRecord.hh
+/// \brief Definition of the VoxelEntryRecord structure
+
+#pragma once
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// One particle recorded by SteppingAction, either entering a voxel from the
+// water or created by radioactive decay inside a voxel. All output formats
+// (phase-space file, TrackingData) are written from this record.
+
+struct VoxelEntryRecord
+{
+    G4ThreeVector localPosition;  // voxel frame
+    G4ThreeVector worldPosition;
+    G4ThreeVector direction;
+    G4double kineticEnergy{0};
+    G4double energyDeposit{0};    // of the recorded step
+    G4double stepLength{0};
+    G4double globalTime{0};
+    G4double excitationEnergy{0};
+    G4int eventID{0};
+    G4int particleID{0};          // ParticleSpecies::ID
+    G4int pdg{0};                 // PDG code, 100ZZZAAAI for nuclei
+    G4int copyNo{0};              // the voxel's Z layer, k
+    G4int voxelI{0};              // and its column in the layer
+    G4int voxelJ{0};
+    G4int trackID{0};
+    G4int parentID{0};            // 0 for primaries
+    G4int entry{0};               // voxel entries of this track before this one
+};
@@ -0,0 +1,168 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file VoxelLattice.hh
+/// \brief Definition of the VoxelLattice class
+
+#pragma once
+#include "globals.hh"
+#include "G4ThreeVector.hh"
+#include "SpatialHash.hh"
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// The regular lattice of unrotated cubic voxels: voxel (i,j,k) is centred at
+// origin + spacing*(i,j,k), in world coordinates. DetectorConstruction
+// places the voxels from it, whatever the volume hierarchy above them, so
+// the lattice answers geometric questions about voxels in constant time,
+// without the navigator or a touchable history:
+//   voxel ID  (i*nY + j)*nZ + k, as in the scoring and output files
+//   copyNo    k, the Z layer
+//   local     world position minus the voxel centre
+// Voxels must not overlap (spacing >= 2*halfSize).
+//
+// For the random placement the voxels are instead a list of non-overlapping
+// cells (cubes or spheres of the half-size, see CellPacking), found through
+// a SpatialHash. The ID space is then numCells x 1 x 1, the ID being the
+// index in the list, while GetIndices gives the bins of spacing the centre
+// falls in, counted from binOrigin: i, j across and k, the copyNo, in depth.
+//
+// For the radial placement the cells are cubes on concentric cylindrical
+// shells around the z axis (the line source): shell k at radius
+// rMin + k*shellSpacing holds rings of cells spacing apart around the axis
+// (i) and along it (j), centred on z = 0. The ID space is again
+// numCells x 1 x 1 with IDs in (k, i, j) order, and copyNo is k. Finding the
+// cell of a point is analytic, from its radius, azimuth and z.
+
+class VoxelLattice
+{
+public:
+    VoxelLattice() = default;
+    VoxelLattice(const G4ThreeVector &origin, G4double spacing,
+                 G4int nX, G4int nY, G4int nZ, G4double halfSize);
+    VoxelLattice(const std::vector<G4ThreeVector> &centres, G4double halfSize, G4bool spheres,
+                 const G4ThreeVector &binOrigin, G4double spacing);
+    VoxelLattice(G4double rMin, G4double shellSpacing, G4int numShells,
+                 G4double length, G4double spacing, G4double halfSize);
+
+    G4bool IsSpherical() const { return fSpheres; }
+
+    // radial placement only, 0 shells otherwise
+    G4int GetNumShells() const { return fNumShells; }
+    G4double GetShellRadius(G4int shell) const { return fRMin + shell * fShellSpacing; }
+    G4int GetNumShellCells(G4int shell) const { return fShellFirst[shell + 1] - fShellFirst[shell]; }
+
+    G4int GetNX() const { return fNX; }
+    G4int GetNY() const { return fNY; }
+    G4int GetNZ() const { return fNZ; }
+    G4int GetNumVoxels() const { return fNX * fNY * fNZ; }
+    G4double GetSpacing() const { return fSpacing; }
+    G4double GetHalfSize() const { return fHalfSize; }
+
+    G4int GetVoxelID(G4int i, G4int j, G4int k) const { return (i * fNY + j) * fNZ + k; }
+    void GetIndices(G4int voxelID, G4int &i, G4int &j, G4int &k) const
+    {
+        if (fExplicit)
+        {
+            const Cell &cell = fCells[voxelID];
+            i = cell.i;
+            j = cell.j;
+            k = cell.k;
+            return;
+        }
+        k = voxelID % fNZ;
+        j = (voxelID / fNZ) % fNY;
+        i = voxelID / (fNZ * fNY);
+    }
+    G4int GetCopyNo(G4int voxelID) const { return fExplicit ? fCells[voxelID].k : voxelID % fNZ; }
+
+    G4ThreeVector GetCentre(G4int i, G4int j, G4int k) const
+    {
+        return fOrigin + G4ThreeVector(i * fSpacing, j * fSpacing, k * fSpacing);
+    }
+    G4ThreeVector GetCentre(G4int voxelID) const
+    {
+        if (fExplicit)
+            return fCells[voxelID].centre;
+        G4int i, j, k;
+        GetIndices(voxelID, i, j, k);
+        return GetCentre(i, j, k);
+    }
+    G4ThreeVector ToLocal(const G4ThreeVector &world, G4int voxelID) const
+    {
+        return world - GetCentre(voxelID);
+    }
+
+    // voxel containing the point, its surface widened by tolerance (for
+    // points on a boundary); -1 between or outside the voxels
+    G4int FindVoxelID(const G4ThreeVector &world, G4double tolerance = 0) const;
+
+    // axis-aligned box enclosing all voxels
+    const G4ThreeVector &GetMin() const { return fMin; }
+    const G4ThreeVector &GetMax() const { return fMax; }
+    G4bool IsInBoundingBox(const G4ThreeVector &world) const;
+
+    // distance from the point to the bounding box, or to the nearest voxel;
+    // 0 inside
+    G4double DistanceToBoundingBox(const G4ThreeVector &world) const;
+    G4double DistanceToNearestVoxel(const G4ThreeVector &world) const;
+
+private:
+    struct Cell
+    {
+        G4ThreeVector centre;
+        G4int i, j, k;
+    };
+
+    void SetCells(std::vector<Cell> &&cells);
+    G4int FindShellCell(const G4ThreeVector &world, G4double tolerance) const;
+    G4bool Contains(G4int voxelID, const G4ThreeVector &world, G4double tolerance) const;
+    G4double DistanceToVoxel(G4int voxelID, const G4ThreeVector &world) const;
+
+    G4ThreeVector fOrigin;    // centre of voxel (0,0,0)
+    G4double fSpacing{0};
+    G4int fNX{0};
+    G4int fNY{0};
+    G4int fNZ{0};
+    G4double fHalfSize{0};
+    G4ThreeVector fMin;
+    G4ThreeVector fMax;
+
+    // random and radial placements
+    G4bool fExplicit{false};
+    G4bool fSpheres{false};
+    std::vector<Cell> fCells;
+    SpatialHash fHash;
+
+    // radial placement
+    G4double fRMin{0};
+    G4double fShellSpacing{0};
+    G4int fNumShells{0};
+    G4int fNumRings{0};               // rings along z per shell
+    std::vector<G4int> fShellFirst;   // first ID of each shell, and the total
+
+};
@@ -0,0 +1,73 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file VoxelScorer.hh
+/// \brief Definition of the VoxelScorer class
+
+#pragma once
+#include "globals.hh"
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Per-voxel energy deposit, dose and track-length fluence.
+// Sums are kept in flat arrays indexed by the voxel ID assigned in
+// DetectorConstruction, (i*ndiv_Y + j)*ndiv_Z + k. Each thread fills its own
+// instance; worker instances are merged into the master one at end of run.
+
+class VoxelScorer
+{
+public:
+    VoxelScorer();
+    ~VoxelScorer();
+
+    void Reset(G4int nX, G4int nY, G4int nZ);
+
+    void AddStep(G4int voxelID, G4double eDep, G4double stepLength)
+    {
+        fEdep[voxelID] += eDep;
+        fTrackLength[voxelID] += stepLength;
+    }
+    void AddEntry(G4int voxelID) { ++fEntries[voxelID]; }
+
+    void Merge(const VoxelScorer &other);
+    void Write(const G4String &fileName, G4int numEvents) const;
+
+    G4int GetNumberOfVoxels() const { return (G4int)fEdep.size(); }
+
+    static void SetMasterInstance(VoxelScorer *master) { fgMasterInstance = master; }
+    static VoxelScorer *GetMasterInstance() { return fgMasterInstance; }
+
+private:
+    G4int fNX{0};
+    G4int fNY{0};
+    G4int fNZ{0};
+    std::vector<G4double> fEdep;
+    std::vector<G4double> fTrackLength;
+    std::vector<G4long> fEntries;
+
+    static VoxelScorer *fgMasterInstance;
+};
@@ -0,0 +1,69 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file WorkerInitialization.hh
+/// \brief Definition of the WorkerInitialization class
+
+#pragma once
+#include "G4UserWorkerInitialization.hh"
+#include "globals.hh"
+#include <vector>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Pins each worker thread as soon as it starts, before it builds its
+// physics tables and output buffers, so that the pages it first touches
+// are allocated on its own NUMA node. Selected with -pin:
+//   core - worker N runs on the N-th allowed CPU (round robin)
+//   numa - worker N may run on any CPU of NUMA node N % number of nodes
+// Linux only; elsewhere a warning is printed and threads are left alone.
+
+class WorkerInitialization : public G4UserWorkerInitialization
+{
+public:
+    enum class Placement
+    {
+        None,
+        Core,
+        Numa
+    };
+
+    explicit WorkerInitialization(Placement placement);
+    ~WorkerInitialization() override;
+
+    static Placement ParsePlacement(const G4String &name);
+
+    void WorkerInitialize() const override;
+
+private:
+    // CPUs the process may run on, and the allowed CPUs of each NUMA node
+    static std::vector<G4int> AllowedCPUs();
+    static std::vector<std::vector<G4int>> NumaNodeCPUs(const std::vector<G4int> &allowed);
+
+    Placement fPlacement;
+    std::vector<G4int> fAllowedCPUs;
+    std::vector<std::vector<G4int>> fNodeCPUs;
+};
@@ -0,0 +1,189 @@
+#!/usr/bin/env python3
+"""Read alphaBeam phase-space (.bin) files into numpy arrays.
+
+Both the float format (12 floats per record, no header) and the compact
+format (header "ABPSC001", see include/CompactRecordCodec.hh) are decoded to
+the same columns: x, y, z [mm, voxel frame], dx, dy, dz, E [MeV], eventID,
+particleID, copyNo, t [s], Eexc, then trackID, parentID, entry for files
+written with -lineage and the voxel indices i, j for -psvoxel (-1
+otherwise), and the PDG code (100ZZZAAA0 for nuclei). particleID 1-4 imply
+their PDG code; ions (5) and other species (6) need the species field,
+written with -species ion or other. Compact files flag these fields in their
+header; float files have none, so pass lineage=True, voxel=True and/or
+species=True for them.
+
+read_index() loads the block index psSort writes next to a sorted file.
+
+Usage: python3 readPS.py output.bin [--lineage] [--voxel] [--species]   (prints a summary)
+       from readPS import read; records = read("output.bin")
+"""
+
+import struct
+import sys
+import zlib
+
+import numpy as np
+
+DTYPE = np.dtype([("x", "f8"), ("y", "f8"), ("z", "f8"),
+                  ("dx", "f8"), ("dy", "f8"), ("dz", "f8"),
+                  ("E", "f8"), ("eventID", "i8"), ("particleID", "i4"),
+                  ("copyNo", "i8"), ("t", "f8"), ("Eexc", "f8"),
+                  ("trackID", "i8"), ("parentID", "i8"), ("entry", "i8"),
+                  ("i", "i8"), ("j", "i8"), ("pdg", "i8")])
+LINEAGE_FIELDS = ("trackID", "parentID", "entry")
+VOXEL_FIELDS = ("i", "j")
+SPECIES_FIELDS = ("pdgCode", "Z", "A")
+# PDG codes of particleID 1-4 (e-, gamma, alpha, proton)
+PDG = np.array([0, 11, 22, 1000020040, 2212, 0, 0])
+
+MAGIC = b"ABPSC001"
+LOG_EMIN, LOG_EMAX = -6.0, 4.0
+EVENT_FLAG, COPYNO_FLAG = 0x08, 0x10
+ZLIB_FLAG, LINEAGE_FLAG, VOXEL_FLAG, SPECIES_FLAG = 0x01, 0x02, 0x04, 0x08
+ION = 5  # particleID of ions; 6, other species, also carries its PDG code
+
+
+def read(fileName, lineage=False, voxel=False, species=False):
+    with open(fileName, "rb") as f:
+        data = f.read()
+    if data[:8] == MAGIC:
+        return _read_compact(data)
+    return _read_float(data, lineage, voxel, species)
+
+
+def read_index(fileName):
+    """psSort block index: one row per block of a layer's records."""
+    return np.genfromtxt(fileName, names=True, dtype="i8")
+
+
+def _read_float(data, lineage, voxel, species):
+    names = list(DTYPE.names[:12])
+    if lineage:
+        names += LINEAGE_FIELDS
+    if voxel:
+        names += VOXEL_FIELDS
+    if species:
+        names += SPECIES_FIELDS
+    raw = np.frombuffer(data, dtype="<f4").reshape(-1, len(names))
+    out = np.full(len(raw), -1, dtype=DTYPE)
+    for i, name in enumerate(names):
+        if name in out.dtype.names:
+            out[name] = raw[:, i]
+    out["pdg"] = PDG[out["particleID"]]
+    if species:
+        pdg, Z, A = (raw[:, names.index(f)].astype("i8") for f in SPECIES_FIELDS)
+        out["pdg"] = np.where(Z != 0, 1000000000 + Z * 10000 + A * 10, pdg)
+    return out
+
+
+def _varint(buf, pos):
+    shift, value = 0, 0
+    while True:
+        b = buf[pos]
+        pos += 1
+        value |= (b & 0x7F) << shift
+        shift += 7
+        if b < 0x80:
+            break
+    return (value >> 1) ^ -(value & 1), pos
+
+
+def _read_compact(data):
+    flags, halfSize = struct.unpack_from("<If", data, 8)
+    pos = 16
+    blocks = []
+    while pos < len(data):
+        numRecords, rawBytes, storedBytes = struct.unpack_from("<III", data, pos)
+        pos += 12
+        payload = data[pos:pos + storedBytes]
+        pos += storedBytes
+        if storedBytes != rawBytes:
+            payload = zlib.decompress(payload)
+        blocks.append(_decode_block(payload, numRecords, halfSize, flags & LINEAGE_FLAG,
+                                    flags & VOXEL_FLAG, flags & SPECIES_FLAG))
+    if not blocks:
+        return np.empty(0, dtype=DTYPE)
+    return np.concatenate(blocks)
+
+
+def _decode_block(buf, numRecords, halfSize, lineage, voxel, species):
+    tags = np.empty(numRecords, dtype="u1")
+    eventID = np.empty(numRecords, dtype="i8")
+    copyNo = np.empty(numRecords, dtype="i8")
+    trackID = np.full(numRecords, -1, dtype="i8")
+    parentID = np.full(numRecords, -1, dtype="i8")
+    entry = np.full(numRecords, -1, dtype="i8")
+    voxelI = np.full(numRecords, -1, dtype="i8")
+    voxelJ = np.full(numRecords, -1, dtype="i8")
+    pdg = np.zeros(numRecords, dtype="i8")
+    excitation = np.zeros(numRecords, dtype="f8")
+    offsets = np.empty(numRecords, dtype="i8")
+    pos, lastEvent, lastCopy, lastTrack = 0, 0, 0, 0
+    for i in range(numRecords):
+        tag = buf[pos]
+        pos += 1
+        if tag & EVENT_FLAG:
+            delta, pos = _varint(buf, pos)
+            lastEvent += delta
+        if tag & COPYNO_FLAG:
+            delta, pos = _varint(buf, pos)
+            lastCopy += delta
+        if species and (tag & 0x07) >= ION:
+            pdg[i], pos = _varint(buf, pos)
+            if (tag & 0x07) == ION:
+                excitation[i] = struct.unpack_from("<f", buf, pos)[0]
+                pos += 4
+        if lineage:
+            delta, pos = _varint(buf, pos)
+            lastTrack += delta
+            generation, pos = _varint(buf, pos)
+            trackID[i], parentID[i] = lastTrack, lastTrack - generation
+            entry[i], pos = _varint(buf, pos)
+        if voxel:
+            voxelI[i], pos = _varint(buf, pos)
+            voxelJ[i], pos = _varint(buf, pos)
+        tags[i], eventID[i], copyNo[i], offsets[i] = tag, lastEvent, lastCopy, pos
+        pos += 16
+
+    fixed = np.frombuffer(buf, dtype="u1")
+    rows = fixed[offsets[:, None] + np.arange(16)]
+    u16 = rows[:, :12].copy().view("<u2")
+    time = rows[:, 12:].copy().view("<f4")[:, 0]
+
+    out = np.empty(numRecords, dtype=DTYPE)
+    px = u16[:, 0] / 65535.0 * 2 - 1
+    py = u16[:, 1] / 65535.0 * 2 - 1
+    pz = 1 - np.abs(px) - np.abs(py)
+    fold = pz < 0
+    ox = (1 - np.abs(py)) * np.where(px >= 0, 1.0, -1.0)
+    oy = (1 - np.abs(px)) * np.where(py >= 0, 1.0, -1.0)
+    px, py = np.where(fold, ox, px), np.where(fold, oy, py)
+    norm = np.sqrt(px * px + py * py + pz * pz)
+    out["dx"], out["dy"], out["dz"] = px / norm, py / norm, pz / norm
+
+    q = u16[:, 2:5].view("<i2")
+    out["x"], out["y"], out["z"] = (q / 32767.0 * halfSize).T
+
+    e = u16[:, 5].astype("f8")
+    out["E"] = np.where(e == 0, 0.0,
+                        10 ** (LOG_EMIN + (e - 1) / 65534.0 * (LOG_EMAX - LOG_EMIN)))
+    out["eventID"] = eventID
+    out["particleID"] = tags & 0x07
+    out["copyNo"] = copyNo
+    out["t"] = time
+    out["Eexc"] = excitation
+    out["pdg"] = np.where(out["particleID"] >= ION, pdg, PDG[out["particleID"]])
+    out["trackID"], out["parentID"], out["entry"] = trackID, parentID, entry
+    out["i"], out["j"] = voxelI, voxelJ
+    return out
+
+
+if __name__ == "__main__":
+    records = read(sys.argv[1], "--lineage" in sys.argv[2:], "--voxel" in sys.argv[2:],
+                   "--species" in sys.argv[2:])
+    print(f"{len(records)} records")
+    if len(records):
+        for p in np.unique(records["pdg"]):
+            sel = records["pdg"] == p
+            print(f"  pdg {p} (particleID {records['particleID'][sel][0]}): {sel.sum()} records, "
+                  f"mean E {records['E'][sel].mean():.6g} MeV")
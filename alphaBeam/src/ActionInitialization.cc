@@ -32,6 +32,11 @@
 #include "G4RunManager.hh"
 #include "PrimaryGeneratorAction.hh"
 #include "EventAction.hh"
+#include "StackingAction.hh"
+#include "TrackingAction.hh"
+#include "CommandLineParser.hh"
+
+using namespace G4DNAPARSER;
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
@@ -47,7 +52,10 @@ ActionInitialization::~ActionInitialization()
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
 void ActionInitialization::BuildForMaster() const
-{}
+{
+    // collects step counts and thread load from the workers, writes voxel scores
+    SetUserAction(new RunAction());
+}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
@@ -57,6 +65,14 @@ void ActionInitialization::Build() const
     RunAction* pRunAction = new RunAction();
     SetUserAction(pRunAction);
     SetUserAction(new EventAction());
-    SteppingAction* pSteppingAction = new SteppingAction();
-    SetUserAction(pSteppingAction);
+    // specialised for the output sinks, see SteppingAction
+    SetUserAction(SteppingAction::Create());
+
+    // -replay forces whole events on one thread
+    CommandLineParser *parser = CommandLineParser::GetParser();
+    if (parser->GetCommandIfActive("-subevents") && !parser->GetCommandIfActive("-replay"))
+    {
+        SetUserAction(new StackingAction());
+        SetUserAction(new TrackingAction());
+    }
 }
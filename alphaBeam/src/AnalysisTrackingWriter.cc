@@ -0,0 +1,140 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file AnalysisTrackingWriter.cc
+/// \brief Implementation of the AnalysisTrackingWriter class
+
+#include "AnalysisTrackingWriter.hh"
+#include "VoxelEntryRecord.hh"
+#include "G4AnalysisManager.hh"
+#include "G4SystemOfUnits.hh"
+#include <string>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool AnalysisTrackingWriter::Open(const G4String &fileName)
+{
+    G4AnalysisManager *analysisManager = G4AnalysisManager::Instance();
+    analysisManager->SetDefaultFileType("root");
+    analysisManager->SetVerboseLevel(0);
+
+    // open output file
+    //
+    G4bool fileOpen = analysisManager->OpenFile(fileName);
+    if (!fileOpen)
+    {
+        G4cout << "\n---> HistoManager::book(): cannot open " << fileName << G4endl;
+        return false;
+    }
+    fFileName = analysisManager->GetFileName();
+    if (!G4StrUtil::ends_with(fFileName, ".root"))
+        fFileName += ".root";
+
+    G4cout << "\n----> Histogram file is opened in " << fileName << G4endl;
+
+    analysisManager->CreateNtuple("Info", "Info");
+    analysisManager->CreateNtupleDColumn("NumPrimaries");
+    analysisManager->CreateNtupleSColumn("GitHash");
+    analysisManager->CreateNtupleDColumn("GeometricEfficiency");
+    // G4 ntuples have no 64-bit integer column; a double would round seeds
+    // above 2^53, so the seed is kept as its decimal text
+    analysisManager->CreateNtupleSColumn("Seed");
+    analysisManager->CreateNtupleIColumn("Skipped", fSkippedEvents);
+    analysisManager->CreateNtupleDColumn("Rmin_um");
+    analysisManager->CreateNtupleDColumn("Rmax_um");
+    analysisManager->CreateNtupleIColumn("NumCells", fCellsPerShell);
+    analysisManager->FinishNtuple(0);
+
+
+    analysisManager->CreateNtuple("TrackingData", "TrackingData");
+    analysisManager->CreateNtupleIColumn(1, "EventID");
+    analysisManager->CreateNtupleDColumn(1, "particleEnergy_MeV");
+    analysisManager->CreateNtupleDColumn(1, "eDep_MeV");
+    analysisManager->CreateNtupleIColumn(1, "particleID");
+    analysisManager->CreateNtupleIColumn(1, "copyNo");
+    analysisManager->CreateNtupleDColumn(1, "posX");
+    analysisManager->CreateNtupleDColumn(1, "posY");
+    analysisManager->CreateNtupleDColumn(1, "posZ");
+    analysisManager->CreateNtupleDColumn(1, "stepLength");
+    analysisManager->CreateNtupleIColumn(1, "trackID");
+    analysisManager->CreateNtupleIColumn(1, "parentID");
+    analysisManager->CreateNtupleIColumn(1, "entry");
+    analysisManager->CreateNtupleIColumn(1, "pdg");
+    analysisManager->FinishNtuple(1);
+
+    fNumRecords = 0;
+    return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void AnalysisTrackingWriter::Fill(const VoxelEntryRecord &record)
+{
+    StartTimer();
+    G4AnalysisManager *analysisManager = G4AnalysisManager::Instance();
+
+    analysisManager->FillNtupleIColumn(1, 0, record.eventID);
+    analysisManager->FillNtupleDColumn(1, 1, record.kineticEnergy / MeV);
+    analysisManager->FillNtupleDColumn(1, 2, record.energyDeposit / MeV);
+    analysisManager->FillNtupleIColumn(1, 3, record.particleID);
+    analysisManager->FillNtupleIColumn(1, 4, record.copyNo);
+    analysisManager->FillNtupleDColumn(1, 5, record.worldPosition.x() / nanometer);
+    analysisManager->FillNtupleDColumn(1, 6, record.worldPosition.y() / nanometer);
+    analysisManager->FillNtupleDColumn(1, 7, record.worldPosition.z() / nanometer);
+    analysisManager->FillNtupleDColumn(1, 8, record.stepLength);
+    analysisManager->FillNtupleIColumn(1, 9, record.trackID);
+    analysisManager->FillNtupleIColumn(1, 10, record.parentID);
+    analysisManager->FillNtupleIColumn(1, 11, record.entry);
+    analysisManager->FillNtupleIColumn(1, 12, record.pdg);
+    analysisManager->AddNtupleRow(1);
+    fNumRecords++;
+    StopTimer();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void AnalysisTrackingWriter::Close(const RunInfo &info)
+{
+    StartTimer();
+    G4AnalysisManager *analysisManager = G4AnalysisManager::Instance();
+
+    analysisManager->FillNtupleDColumn(0,0, info.numPrimaries);
+    analysisManager->FillNtupleSColumn(0,1, info.gitHash);
+    analysisManager->FillNtupleDColumn(0,2, info.geometricEfficiency);
+    analysisManager->FillNtupleSColumn(0,3, std::to_string(info.masterSeed));
+    fSkippedEvents = info.skippedEvents;
+    analysisManager->FillNtupleDColumn(0,5, info.rMin / um);
+    analysisManager->FillNtupleDColumn(0,6, info.rMax / um);
+    fCellsPerShell = info.cellsPerShell;
+    analysisManager->AddNtupleRow(0);
+
+    analysisManager->Write();
+    analysisManager->CloseFile();
+    analysisManager->Clear();
+    StopTimer();
+    G4cout << "\n----> Histograms are saved" << G4endl;
+    PrintThroughput("g4", fFileName);
+}
@@ -0,0 +1,230 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+//
+/// \file CellPacking.cc
+/// \brief Implementation of the CellPacking class
+
+#include "CellPacking.hh"
+#include "SpatialHash.hh"
+#include "G4SystemOfUnits.hh"
+#include "CLHEP/Random/MixMaxRng.h"
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+const G4double kGrid = 0.01 * nanometer;
+
+G4double Quantise(G4double x)
+{
+  return std::round(x / kGrid) * kGrid;
+}
+
+struct FileHeader
+{
+  char magic[8];
+  std::uint32_t shape, region, numRequested, numPlaced;
+  double halfSize, halfWidth, thickness, radius, startZ;
+  std::uint64_t seed;
+};
+
+FileHeader MakeHeader(const CellPacking::Spec &spec, std::uint32_t numPlaced)
+{
+  FileHeader header;
+  std::memcpy(header.magic, "ABCELLS2", 8);
+  header.shape = spec.shape;
+  header.region = spec.region;
+  header.numRequested = spec.numCells;
+  header.numPlaced = numPlaced;
+  header.halfSize = spec.halfSize / mm;
+  header.halfWidth = spec.halfWidth / mm;
+  header.thickness = spec.thickness / mm;
+  header.radius = spec.radius / mm;
+  header.startZ = spec.startZ / mm;
+  header.seed = spec.seed;
+  return header;
+}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4ThreeVector CellPacking::GetRegionMin(const Spec &spec)
+{
+  if (spec.region == kSphere)
+    return G4ThreeVector(-spec.radius, -spec.radius, spec.startZ);
+  return G4ThreeVector(-spec.halfWidth, -spec.halfWidth, spec.startZ);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::vector<G4ThreeVector> CellPacking::Generate(const Spec &spec)
+{
+  auto start = std::chrono::steady_clock::now();
+  G4double h = spec.halfSize;
+  std::vector<G4ThreeVector> centres;
+  centres.reserve(spec.numCells);
+
+  // centres keeping the whole cell in the region: a box within R of the
+  // sphere centre needs its corners inside
+  G4ThreeVector sphereCentre(0, 0, spec.startZ + spec.radius);
+  G4double reachRadius = spec.radius - (spec.shape == kOrb ? h : h * std::sqrt(3.));
+  G4double reachXY = spec.halfWidth - h;
+  G4double reachZ = 0.5 * spec.thickness - h;
+  if ((spec.region == kSphere && reachRadius < 0) || (spec.region == kSlab && (reachXY < 0 || reachZ < 0)))
+  {
+    G4ExceptionDescription msg;
+    msg << "A cell of half-size " << h / nm << " nm does not fit in the placement region";
+    G4Exception("CellPacking::Generate", "CellPacking001", FatalException, msg);
+    return centres;
+  }
+
+  // cubes overlap when their centres are within 2h along every axis, one
+  // hash cell of side 2h; spheres when within 2h, the diagonal of a cell of
+  // side 2h/sqrt(3), so up to two cells apart
+  SpatialHash hash;
+  hash.Reset(spec.shape == kOrb ? 2 * h / std::sqrt(3.) : 2 * h, spec.numCells);
+  G4int reach = (spec.shape == kOrb) ? 2 : 1;
+
+  // flat() is the same on every platform, unlike the std distributions;
+  // draws go through locals, as argument evaluation order is unspecified
+  CLHEP::MixMaxRng engine((long)spec.seed);
+  auto uniform = [&engine]() { return 2 * engine.flat() - 1; };
+  G4long maxAttempts = (G4long)kAttemptsPerCell * spec.numCells;
+  G4long attempts = 0;
+  while ((G4int)centres.size() < spec.numCells && attempts < maxAttempts)
+  {
+    attempts++;
+    G4ThreeVector candidate;
+    if (spec.region == kSlab)
+    {
+      G4double x = uniform();
+      G4double y = uniform();
+      G4double z = uniform();
+      candidate.set(reachXY * x, reachXY * y, spec.startZ + 0.5 * spec.thickness + reachZ * z);
+    }
+    else
+    {
+      G4ThreeVector offset;
+      do
+      {
+        G4double x = uniform();
+        G4double y = uniform();
+        offset.set(x, y, uniform());
+      } while (offset.mag2() > 1);
+      candidate = sphereCentre + reachRadius * offset;
+    }
+    candidate.set(Quantise(candidate.x()), Quantise(candidate.y()), Quantise(candidate.z()));
+
+    G4bool overlaps = false;
+    hash.ForEachNear(candidate, reach, [&](G4int id) {
+      G4ThreeVector d = candidate - centres[id];
+      if (spec.shape == kOrb)
+        overlaps |= d.mag2() < 4 * h * h;
+      else
+        overlaps |= std::abs(d.x()) < 2 * h && std::abs(d.y()) < 2 * h && std::abs(d.z()) < 2 * h;
+    });
+    if (overlaps || !hash.Insert(candidate, (G4int)centres.size()))
+      continue;
+    centres.push_back(candidate);
+  }
+
+  std::chrono::duration<G4double> elapsed = std::chrono::steady_clock::now() - start;
+  G4cout << "CellPacking: placed " << centres.size() << " of " << spec.numCells << " cells in "
+         << attempts << " attempts, " << elapsed.count() << " s" << G4endl;
+  if ((G4int)centres.size() < spec.numCells)
+  {
+    G4ExceptionDescription msg;
+    msg << "Only " << centres.size() << " of " << spec.numCells
+        << " cells fit after " << attempts << " attempts; the region is jammed, enlarge it or ask for fewer cells";
+    G4Exception("CellPacking::Generate", "CellPacking002", JustWarning, msg);
+  }
+  return centres;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool CellPacking::Load(const G4String &fileName, const Spec &spec, std::vector<G4ThreeVector> &centres)
+{
+  std::ifstream in(fileName, std::ios::in | std::ios::binary);
+  if (!in)
+    return false;
+
+  FileHeader header;
+  if (!in.read((char *)&header, sizeof(header)))
+    return false;
+  FileHeader expected = MakeHeader(spec, header.numPlaced);
+  if (std::memcmp(&header, &expected, sizeof(header)) != 0)
+    return false;
+
+  std::vector<std::int32_t> grid(3 * (std::size_t)header.numPlaced);
+  if (!in.read((char *)grid.data(), grid.size() * sizeof(std::int32_t)))
+    return false;
+  centres.resize(header.numPlaced);
+  for (std::size_t i = 0; i < centres.size(); i++)
+    centres[i].set(grid[3 * i] * kGrid, grid[3 * i + 1] * kGrid, grid[3 * i + 2] * kGrid);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void CellPacking::Save(const G4String &fileName, const Spec &spec, const std::vector<G4ThreeVector> &centres)
+{
+  std::ofstream out(fileName, std::ios::out | std::ios::binary);
+  if (!out)
+  {
+    G4cout << "\n---> CellPacking::Save(): cannot open " << fileName << G4endl;
+    return;
+  }
+
+  FileHeader header = MakeHeader(spec, (std::uint32_t)centres.size());
+  out.write((char *)&header, sizeof(header));
+
+  std::vector<std::int32_t> grid;
+  grid.reserve(3 * centres.size());
+  for (const G4ThreeVector &centre : centres)
+    for (G4int axis = 0; axis < 3; axis++)
+      grid.push_back((std::int32_t)std::lround(centre[axis] / kGrid));
+  out.write((char *)grid.data(), grid.size() * sizeof(std::int32_t));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::vector<G4ThreeVector> CellPacking::Place(const Spec &spec, const G4String &fileName)
+{
+  std::vector<G4ThreeVector> centres;
+  if (!fileName.empty() && Load(fileName, spec, centres))
+  {
+    G4cout << "CellPacking: " << centres.size() << " cells from " << fileName << G4endl;
+    return centres;
+  }
+  centres = Generate(spec);
+  if (!fileName.empty())
+    Save(fileName, spec, centres);
+  return centres;
+}
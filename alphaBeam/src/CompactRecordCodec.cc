@@ -0,0 +1,95 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file CompactRecordCodec.cc
+/// \brief Implementation of the CompactRecordCodec class
+
+#include "CompactRecordCodec.hh"
+#include "VoxelEntryRecord.hh"
+#include "ParticleSpecies.hh"
+#include "G4SystemOfUnits.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::size_t CompactRecordCodec::Encode(const VoxelEntryRecord &record, std::uint8_t *out)
+{
+  std::size_t n = 1;
+  std::uint8_t tag = (std::uint8_t)(record.particleID & 0x07);
+
+  if (fFirst || record.eventID != fLastEventID)
+  {
+    tag |= kEventFlag;
+    n += PutVarint((std::int64_t)record.eventID - fLastEventID, out + n);
+    fLastEventID = record.eventID;
+  }
+  if (fFirst || record.copyNo != fLastCopyNo)
+  {
+    tag |= kCopyNoFlag;
+    n += PutVarint((std::int64_t)record.copyNo - fLastCopyNo, out + n);
+    fLastCopyNo = record.copyNo;
+  }
+  fFirst = false;
+  out[0] = tag;
+
+  if (fSpecies && record.particleID >= ParticleSpecies::kIon)
+  {
+    n += PutVarint(record.pdg, out + n);
+    if (record.particleID == ParticleSpecies::kIon)
+    {
+      float excitation = record.excitationEnergy / MeV;
+      std::memcpy(out + n, &excitation, sizeof(excitation));
+      n += sizeof(excitation);
+    }
+  }
+
+  if (fLineage)
+  {
+    n += PutVarint((std::int64_t)record.trackID - fLastTrackID, out + n);
+    n += PutVarint((std::int64_t)record.trackID - record.parentID, out + n);
+    n += PutVarint(record.entry, out + n);
+    fLastTrackID = record.trackID;
+  }
+  if (fVoxel)
+  {
+    n += PutVarint(record.voxelI, out + n);
+    n += PutVarint(record.voxelJ, out + n);
+  }
+
+  std::uint16_t fixed16[6];
+  EncodeDirection(record.direction.x(), record.direction.y(), record.direction.z(), fixed16);
+  fixed16[2] = (std::uint16_t)EncodePosition(record.localPosition.x() / mm, fHalfSize);
+  fixed16[3] = (std::uint16_t)EncodePosition(record.localPosition.y() / mm, fHalfSize);
+  fixed16[4] = (std::uint16_t)EncodePosition(record.localPosition.z() / mm, fHalfSize);
+  fixed16[5] = EncodeEnergy(record.kineticEnergy / MeV);
+  std::memcpy(out + n, fixed16, sizeof(fixed16));
+  n += sizeof(fixed16);
+
+  float time = record.globalTime / s;
+  std::memcpy(out + n, &time, sizeof(time));
+  n += sizeof(time);
+
+  return n;
+}
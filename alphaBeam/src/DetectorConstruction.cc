@@ -41,7 +41,10 @@
 #include "G4UserLimits.hh"
 #include "G4UnitsTable.hh"
 #include "G4LogicalVolumeStore.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4SolidStore.hh"
 #include "G4PVPlacement.hh"
+#include <vector>
 
 #include "CommandLineParser.hh"
 
@@ -53,6 +56,9 @@
 #include "DetectorMessenger.hh"
 
 #include "RunAction.hh"
+#include "NavigationBenchmark.hh"
+#include "G4GeometryManager.hh"
+#include "G4TransportationManager.hh"
 
 using namespace G4DNAPARSER;
 
@@ -77,6 +83,21 @@ DetectorConstruction::DetectorConstruction() : G4VUserDetectorConstruction()
 {
   // R = {155 * micrometer, 175 * micrometer, 195 * micrometer, 215 * micrometer, 235 * micrometer, 255 * micrometer, 275 * micrometer, 295 * micrometer, 315 * micrometer, 335 * micrometer};
 
+  // unlimited until set with /det/limits/
+  for (G4int i = 0; i < kNumVolumeClasses; i++)
+    fUserLimits[i] = new G4UserLimits();
+
+  fCellSpec.numCells = 1000;
+  fCellSpec.halfWidth = 25 * micrometer;
+  fCellSpec.thickness = 50 * micrometer;
+  fCellSpec.radius = 25 * micrometer;
+
+  // the shells of the wire-source geometry, 155 to 335 um
+  fShellSpec.rMin = 155 * micrometer;
+  fShellSpec.spacing = 20 * micrometer;
+  fShellSpec.number = 10;
+  fShellSpec.length = 2 * micrometer;
+
   fDetectorMessenger = new DetectorMessenger(this);
 }
 
@@ -84,12 +105,20 @@ DetectorConstruction::DetectorConstruction() : G4VUserDetectorConstruction()
 
 DetectorConstruction::~DetectorConstruction()
 {
+  for (G4int i = 0; i < kNumVolumeClasses; i++)
+    delete fUserLimits[i];
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 G4VPhysicalVolume *DetectorConstruction::Construct()
 {
+  // a /det/ command rebuilds the geometry between runs; drop the previous
+  // one so the stores, and the navigator's voxelisation, do not keep growing
+  G4GeometryManager::GetInstance()->OpenGeometry();
+  G4PhysicalVolumeStore::GetInstance()->Clean();
+  G4LogicalVolumeStore::GetInstance()->Clean();
+  G4SolidStore::GetInstance()->Clean();
 
   /***************************************************************************/
   //                               World
@@ -108,7 +137,11 @@ G4VPhysicalVolume *DetectorConstruction::Construct()
 
   G4Box *solidWater = new G4Box("water", 10 * mm, 10 * mm, 10 * mm);
 
-  G4Box *solidVoxel = new G4Box("voxel", nucleusSize/2+margin, nucleusSize/2 + margin, nucleusSize/2 + margin);
+  G4VSolid *solidVoxel;
+  if (fPlacement == kRandomPlacement && fCellSpec.shape == CellPacking::kOrb)
+    solidVoxel = new G4Orb("voxel", nucleusSize/2 + margin);
+  else
+    solidVoxel = new G4Box("voxel", nucleusSize/2+margin, nucleusSize/2 + margin, nucleusSize/2 + margin);
   
   G4LogicalVolume *logicWorld = new G4LogicalVolume(solidWorld,
                                                     air,
@@ -138,11 +171,70 @@ G4VPhysicalVolume *DetectorConstruction::Construct()
   G4LogicalVolume *logicVoxel = new G4LogicalVolume(solidVoxel,
                                                          waterMaterial,
                                                          "voxel");
-  G4UserLimits* userLimits = new G4UserLimits();
-  userLimits->SetMaxAllowedStep(3 * nm);
+  logicWorld->SetUserLimits(fUserLimits[kWorldVolume]);
+  logicWater->SetUserLimits(fUserLimits[kWaterVolume]);
+  logicVoxel->SetUserLimits(fUserLimits[kVoxelVolume]);
+  fVoxelVolume = solidVoxel->GetCubicVolume();
+  fVoxelMass = fVoxelVolume * waterMaterial->GetDensity();
   G4int noVoxels =0;
   // G4double spacing = 0.5;
   G4cout << "spacing: " << spacing << ", start_Z: " << start_Z << ", ndiv_Z: " << ndiv_Z << ", ndiv_X: " << ndiv_X << G4endl;
+
+  if (fPlacement != kLatticePlacement)
+  {
+    fNumVoxels = PlaceCells(logicVoxel, logicWater, nucleusSize/2 + margin);
+    logicVoxel->SetVisAttributes(&visBlue);
+    logicWorld->SetVisAttributes(&invisGrey);
+    logicWater->SetVisAttributes(&invisGrey);
+    return physiWorld;
+  }
+
+  fLattice = VoxelLattice(G4ThreeVector(-2.5*um, -2.5*um, start_Z), spacing,
+                          ndiv_X, ndiv_Y, ndiv_Z, nucleusSize/2 + margin);
+  const G4ThreeVector &latticeMin = fLattice.GetMin();
+  const G4ThreeVector &latticeMax = fLattice.GetMax();
+  G4double voxelHalfSize = fLattice.GetHalfSize();
+
+  // Optional intermediate mothers. The slabs and bars are placed first so
+  // that the voxel placements below still get consecutive instance IDs in
+  // voxel-ID order. They are water and have no rotation, so the voxel's
+  // local frame, and thus the local-coordinate output, does not change.
+  G4double centreX = 0.5*(latticeMin.x() + latticeMax.x());
+  G4double centreY = 0.5*(latticeMin.y() + latticeMax.y());
+  std::vector<G4LogicalVolume *> logicMothers;   // index k (layer) or k*ndiv_Y + j (row)
+  std::vector<G4ThreeVector> motherCentres;
+  if (fLayout != kFlat)
+  {
+    G4Box *solidLayer = new G4Box("layer", 0.5*(latticeMax.x() - latticeMin.x()),
+                                  0.5*(latticeMax.y() - latticeMin.y()), voxelHalfSize);
+    G4Box *solidRow = new G4Box("row", 0.5*(latticeMax.x() - latticeMin.x()),
+                                voxelHalfSize, voxelHalfSize);
+    for (G4int k=0; k<ndiv_Z; k++)
+    {
+      G4ThreeVector layerCentre(centreX, centreY, fLattice.GetCentre(0, 0, k).z());
+      G4LogicalVolume *logicLayer = new G4LogicalVolume(solidLayer, waterMaterial, "layer");
+      logicLayer->SetVisAttributes(&invisGrey);
+      logicLayer->SetUserLimits(fUserLimits[kWaterVolume]);
+      new G4PVPlacement(0, layerCentre, logicLayer, "layer", logicWater, false, k, false);
+      if (fLayout == kLayer)
+      {
+        logicMothers.push_back(logicLayer);
+        motherCentres.push_back(layerCentre);
+        continue;
+      }
+      for (G4int j=0; j<ndiv_Y; j++)
+      {
+        G4ThreeVector rowCentre(centreX, fLattice.GetCentre(0, j, k).y(), layerCentre.z());
+        G4LogicalVolume *logicRow = new G4LogicalVolume(solidRow, waterMaterial, "row");
+        logicRow->SetVisAttributes(&invisGrey);
+        logicRow->SetUserLimits(fUserLimits[kWaterVolume]);
+        new G4PVPlacement(0, rowCentre - layerCentre, logicRow, "row", logicLayer, false, j, false);
+        logicMothers.push_back(logicRow);
+        motherCentres.push_back(rowCentre);
+      }
+    }
+  }
+
   for (G4int i=0; i <ndiv_X; i++){
       for (G4int j = 0; j<ndiv_Y; j++){
         for (G4int k=0; k<ndiv_Z; k++){
@@ -152,14 +244,24 @@ G4VPhysicalVolume *DetectorConstruction::Construct()
             //                                   0,
             //                                   0) ;
 
+            G4ThreeVector position = fLattice.GetCentre(i, j, k);
+            G4LogicalVolume *logicMother = logicWater;
+            if (fLayout != kFlat)
+            {
+              G4int motherIndex = (fLayout == kLayer) ? k : k*ndiv_Y + j;
+              logicMother = logicMothers[motherIndex];
+              position -= motherCentres[motherIndex];
+            }
+
             G4PVPlacement *physiCell = new G4PVPlacement(0,
-                                                     G4ThreeVector(-2.5*um + i*spacing, -2.5*um+ j*spacing, start_Z+ k*spacing),
+                                                     position,
                                                      logicVoxel,
                                                      "voxel",
-                                                     logicWater,
+                                                     logicMother,
                                                      0,
                                                      k,
                                                      0);
+        if (noVoxels == 0) fFirstVoxelInstance = physiCell->GetInstanceID();
         noVoxels++; 
         }
 
@@ -167,6 +269,7 @@ G4VPhysicalVolume *DetectorConstruction::Construct()
       }
     
  }
+  fNumVoxels = noVoxels;
   G4cout << "placed " << noVoxels << " voxels. " << G4endl;
   logicVoxel->SetVisAttributes(&visBlue);
   logicWorld->SetVisAttributes(&invisGrey);
@@ -175,6 +278,47 @@ G4VPhysicalVolume *DetectorConstruction::Construct()
   return physiWorld;
 }
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4int DetectorConstruction::PlaceCells(G4LogicalVolume *logicVoxel, G4LogicalVolume *logicWater, G4double halfSize)
+{
+  // no mothers: the navigator's smart voxels split the cells however they
+  // are arranged, so the cost per step stays flat as shells are added
+  if (fLayout != kFlat)
+  {
+    G4Exception("DetectorConstruction::PlaceCells", "DetectorConstruction003", JustWarning,
+                "The random and radial placements have no layer or row mothers, using the flat layout");
+    fLayout = kFlat;
+  }
+
+  if (fPlacement == kRandomPlacement)
+  {
+    CellPacking::Spec spec = fCellSpec;
+    spec.halfSize = halfSize;
+    spec.startZ = start_Z;
+    fLattice = VoxelLattice(CellPacking::Place(spec, fCellFile), halfSize, spec.shape == CellPacking::kOrb,
+                            CellPacking::GetRegionMin(spec), spacing);
+  }
+  else
+    fLattice = VoxelLattice(fShellSpec.rMin, fShellSpec.spacing, fShellSpec.number, fShellSpec.length,
+                            spacing, halfSize);
+
+  // in ID order, so the voxel ID is again the instance ID offset
+  G4int numCells = fLattice.GetNumVoxels();
+  for (G4int id = 0; id < numCells; id++)
+  {
+    G4PVPlacement *physiCell = new G4PVPlacement(0, fLattice.GetCentre(id), logicVoxel, "voxel", logicWater,
+                                                 false, fLattice.GetCopyNo(id), false);
+    if (id == 0)
+      fFirstVoxelInstance = physiCell->GetInstanceID();
+  }
+  G4cout << "placed " << numCells << " cells. " << G4endl;
+  for (G4int shell = 0; shell < fLattice.GetNumShells(); shell++)
+    G4cout << "  shell " << shell << " at " << G4BestUnit(fLattice.GetShellRadius(shell), "Length")
+           << ": " << fLattice.GetNumShellCells(shell) << " cells" << G4endl;
+  return numCells;
+}
+
 
 void DetectorConstruction::set_ndiv_X(G4int value)
 {
@@ -192,6 +336,86 @@ void DetectorConstruction::set_ndiv_Z(G4int value)
   G4RunManager::GetRunManager()->ReinitializeGeometry();
 }
 
+DetectorConstruction::VolumeClass DetectorConstruction::ParseVolumeClass(const G4String &name)
+{
+  for (G4int i = 0; i < kNumVolumeClasses; i++)
+    if (name == GetVolumeClassName((VolumeClass)i))
+      return (VolumeClass)i;
+
+  G4ExceptionDescription msg;
+  msg << "Unknown volume class '" << name << "', expected voxel, water or world";
+  G4Exception("DetectorConstruction::ParseVolumeClass", "DetectorConstruction002", FatalException, msg);
+  return kWorldVolume;
+}
+
+const char *DetectorConstruction::GetVolumeClassName(VolumeClass volumeClass)
+{
+  static const char *names[kNumVolumeClasses] = {"voxel", "water", "world"};
+  return names[volumeClass];
+}
+
+DetectorConstruction::VolumeClass DetectorConstruction::get_volumeClass(const G4LogicalVolume *lv) const
+{
+  // every logical volume carries its class's limits object
+  const G4UserLimits *limits = lv->GetUserLimits();
+  for (G4int i = 0; i < kNumVolumeClasses; i++)
+    if (limits == fUserLimits[i])
+      return (VolumeClass)i;
+  return kWorldVolume;
+}
+
+void DetectorConstruction::set_layout(const G4String &value)
+{
+  if (value == "flat")
+    fLayout = kFlat;
+  else if (value == "layer")
+    fLayout = kLayer;
+  else if (value == "row")
+    fLayout = kRow;
+  else
+  {
+    G4ExceptionDescription msg;
+    msg << "Unknown voxel layout '" << value << "', expected flat, layer or row";
+    G4Exception("DetectorConstruction::set_layout", "DetectorConstruction001", FatalException, msg);
+  }
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+void DetectorConstruction::set_placement(const G4String &value)
+{
+  if (value == "lattice")
+    fPlacement = kLatticePlacement;
+  else if (value == "random")
+    fPlacement = kRandomPlacement;
+  else if (value == "radial")
+    fPlacement = kRadialPlacement;
+  else
+  {
+    G4ExceptionDescription msg;
+    msg << "Unknown voxel placement '" << value << "', expected lattice, random or radial";
+    G4Exception("DetectorConstruction::set_placement", "DetectorConstruction004", FatalException, msg);
+  }
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+void DetectorConstruction::set_cellSpec(const CellPacking::Spec &spec)
+{
+  fCellSpec = spec;
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+void DetectorConstruction::set_cellFile(const G4String &value)
+{
+  fCellFile = value;
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
+void DetectorConstruction::set_shellSpec(const ShellSpec &spec)
+{
+  fShellSpec = spec;
+  G4RunManager::GetRunManager()->ReinitializeGeometry();
+}
+
 void DetectorConstruction::set_spacing(G4double value)
 {
   spacing = value;
@@ -202,4 +426,26 @@ void DetectorConstruction::set_startZ(G4double value)
 {
   start_Z = value;
   G4RunManager::GetRunManager()->ReinitializeGeometry();
-}
\ No newline at end of file
+}
+void DetectorConstruction::benchmark_navigation(G4int numRays)
+{
+  // rebuild the geometry if a /det/ command changed it, then voxelise it as
+  // the run manager would at the start of a run
+  G4RunManager::GetRunManager()->Initialize();
+  G4VPhysicalVolume *world = G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->GetWorldVolume();
+  G4GeometryManager::GetInstance()->OpenGeometry(world);
+  G4GeometryManager::GetInstance()->CloseGeometry(true, false, world);
+
+  NavigationBenchmark::Result result = NavigationBenchmark::Run(world, *this, numRays);
+
+  static const char *layoutNames[] = {"flat", "layer", "row"};
+  G4cout << "Navigation benchmark: layout " << layoutNames[fLayout] << ", ";
+  if (fPlacement == kRandomPlacement)
+    G4cout << fNumVoxels << " random cells, ";
+  else if (fPlacement == kRadialPlacement)
+    G4cout << fNumVoxels << " cells on " << fLattice.GetNumShells() << " shells, ";
+  else
+    G4cout << ndiv_X << "x" << ndiv_Y << "x" << ndiv_Z << " voxels, ";
+  G4cout << numRays << " rays, " << result.numSteps << " steps in " << result.seconds << " s, "
+         << (result.numSteps > 0 ? 1e9*result.seconds/result.numSteps : 0.) << " ns/step" << G4endl;
+}
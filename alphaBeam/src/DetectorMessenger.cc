@@ -40,12 +40,18 @@
 #include "G4UIcmdWithADoubleAndUnit.hh"
 #include "G4UIcmdWithoutParameter.hh"
 #include "G4UIcmdWithAnInteger.hh"
+#include "G4UserLimits.hh"
+#include "SteppingBenchmark.hh"
+#include <sstream>
 
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 DetectorMessenger::DetectorMessenger(DetectorConstruction *Det)
-    : G4UImessenger(), fDetector(Det), spacing(0), start_Z(0), ndiv_X(0), ndiv_Y(0), ndiv_Z(0)
+    : G4UImessenger(), fDetector(Det), spacing(0), start_Z(0), ndiv_X(0), ndiv_Y(0), ndiv_Z(0), layout(0), benchmarkNavigation(0), benchmarkStepping(0),
+      placement(0), cellsDir(0), cellNumber(0), cellShape(0), cellSlab(0), cellSphere(0), cellSeed(0), cellFile(0),
+      shellsDir(0), shellRMin(0), shellSpacing(0), shellNumber(0), shellLength(0),
+      limitsDir(0), maxStep(0), maxTrackLength(0), maxTime(0), minEkin(0)
 {
   start_Z = new G4UIcmdWithADoubleAndUnit("/det/set_startZ",this);
   start_Z->SetGuidance("Set starting Z coords of voxels");
@@ -84,11 +90,171 @@ DetectorMessenger::DetectorMessenger(DetectorConstruction *Det)
   ndiv_Y->SetDefaultValue(10);
   ndiv_Y->AvailableForStates(G4State_PreInit,G4State_Idle);
   ndiv_Y->SetToBeBroadcasted(false);
+
+  layout = new G4UIcmdWithAString("/det/layout",this);
+  layout->SetGuidance("Set voxel hierarchy: flat (voxels directly in water),");
+  layout->SetGuidance("layer (one water slab per Z layer) or row (slab per layer, bar per row)");
+  layout->SetParameterName("layout",false);
+  layout->SetCandidates("flat layer row");
+  layout->AvailableForStates(G4State_PreInit,G4State_Idle);
+  layout->SetToBeBroadcasted(false);
+
+  benchmarkNavigation = new G4UIcmdWithAnInteger("/det/benchmarkNavigation",this);
+  benchmarkNavigation->SetGuidance("Time navigation of N straight rays through the voxel lattice");
+  benchmarkNavigation->SetParameterName("nRays",true);
+  benchmarkNavigation->SetDefaultValue(100000);
+  benchmarkNavigation->SetRange("nRays>0");
+  benchmarkNavigation->AvailableForStates(G4State_Idle);
+  benchmarkNavigation->SetToBeBroadcasted(false);
+
+#ifdef ALPHABEAM_STEPPING_BENCHMARK
+  benchmarkStepping = new G4UIcmdWithAnInteger("/det/benchmarkStepping",this);
+  benchmarkStepping->SetGuidance("Time the stepping action on N synthetic steps of each kind (not recorded,");
+  benchmarkStepping->SetGuidance("crossing into a voxel, decay product in a voxel) in a one-event run");
+  benchmarkStepping->SetParameterName("nSteps",true);
+  benchmarkStepping->SetDefaultValue(1000000);
+  benchmarkStepping->SetRange("nSteps>0");
+  benchmarkStepping->AvailableForStates(G4State_Idle);
+  benchmarkStepping->SetToBeBroadcasted(false);
+#endif
+
+  placement = new G4UIcmdWithAString("/det/placement",this);
+  placement->SetGuidance("Place the voxels on the regular lattice, as non-overlapping cells at");
+  placement->SetGuidance("random positions set up with /det/cells/, or on cylindrical shells");
+  placement->SetGuidance("around the z axis set up with /det/shells/");
+  placement->SetParameterName("placement",false);
+  placement->SetCandidates("lattice random radial");
+  placement->AvailableForStates(G4State_PreInit,G4State_Idle);
+  placement->SetToBeBroadcasted(false);
+
+  cellsDir = new G4UIdirectory("/det/cells/");
+  cellsDir->SetGuidance("Random placement: cells of the voxel size packed without overlaps");
+  cellsDir->SetGuidance("into a slab or sphere starting at start_Z; copyNo is the depth bin of spacing");
+
+  cellNumber = new G4UIcmdWithAnInteger("/det/cells/number",this);
+  cellNumber->SetGuidance("Set the number of cells to place");
+  cellNumber->SetParameterName("number",false);
+  cellNumber->SetRange("number>0");
+  cellNumber->AvailableForStates(G4State_PreInit,G4State_Idle);
+  cellNumber->SetToBeBroadcasted(false);
+
+  cellShape = new G4UIcmdWithAString("/det/cells/shape",this);
+  cellShape->SetGuidance("Set the cell shape: box (as the lattice voxels) or orb (sphere)");
+  cellShape->SetParameterName("shape",false);
+  cellShape->SetCandidates("box orb");
+  cellShape->AvailableForStates(G4State_PreInit,G4State_Idle);
+  cellShape->SetToBeBroadcasted(false);
+
+  cellSlab = new G4UIcommand("/det/cells/slab",this);
+  cellSlab->SetGuidance("Place the cells in the slab |x|,|y| < halfWidth, start_Z < z < start_Z + thickness");
+  G4UIparameter *halfWidth = new G4UIparameter("halfWidth", 'd', false);
+  halfWidth->SetParameterRange("halfWidth>0.");
+  cellSlab->SetParameter(halfWidth);
+  G4UIparameter *thickness = new G4UIparameter("thickness", 'd', false);
+  thickness->SetParameterRange("thickness>0.");
+  cellSlab->SetParameter(thickness);
+  G4UIparameter *slabUnit = new G4UIparameter("unit", 's', true);
+  slabUnit->SetDefaultValue("um");
+  slabUnit->SetParameterCandidates(G4UIcommand::UnitsList("Length"));
+  cellSlab->SetParameter(slabUnit);
+  cellSlab->AvailableForStates(G4State_PreInit,G4State_Idle);
+  cellSlab->SetToBeBroadcasted(false);
+
+  cellSphere = new G4UIcmdWithADoubleAndUnit("/det/cells/sphere",this);
+  cellSphere->SetGuidance("Place the cells in the sphere of this radius touching z = start_Z");
+  cellSphere->SetParameterName("radius",false);
+  cellSphere->SetRange("radius>0.");
+  cellSphere->SetDefaultUnit("micrometer");
+  cellSphere->AvailableForStates(G4State_PreInit,G4State_Idle);
+  cellSphere->SetToBeBroadcasted(false);
+
+  cellSeed = new G4UIcmdWithAnInteger("/det/cells/seed",this);
+  cellSeed->SetGuidance("Set the seed of the placement, independent of the run seeds");
+  cellSeed->SetParameterName("seed",false);
+  cellSeed->AvailableForStates(G4State_PreInit,G4State_Idle);
+  cellSeed->SetToBeBroadcasted(false);
+
+  cellFile = new G4UIcmdWithAString("/det/cells/file",this);
+  cellFile->SetGuidance("Cache the placement in this file: reused when it was made with the");
+  cellFile->SetGuidance("same settings, regenerated and overwritten otherwise");
+  cellFile->SetParameterName("fileName",false);
+  cellFile->AvailableForStates(G4State_PreInit,G4State_Idle);
+  cellFile->SetToBeBroadcasted(false);
+
+  shellsDir = new G4UIdirectory("/det/shells/");
+  shellsDir->SetGuidance("Radial placement: rings of cells set_spacing apart on cylindrical shells");
+  shellsDir->SetGuidance("around the line source on the z axis; copyNo is the shell index");
+
+  shellRMin = new G4UIcmdWithADoubleAndUnit("/det/shells/rMin",this);
+  shellRMin->SetGuidance("Set the radius of the innermost shell");
+  shellRMin->SetParameterName("rMin",false);
+  shellRMin->SetRange("rMin>0.");
+  shellRMin->SetDefaultUnit("micrometer");
+  shellRMin->AvailableForStates(G4State_PreInit,G4State_Idle);
+  shellRMin->SetToBeBroadcasted(false);
+
+  shellSpacing = new G4UIcmdWithADoubleAndUnit("/det/shells/spacing",this);
+  shellSpacing->SetGuidance("Set the radial distance between shells");
+  shellSpacing->SetParameterName("spacing",false);
+  shellSpacing->SetRange("spacing>0.");
+  shellSpacing->SetDefaultUnit("micrometer");
+  shellSpacing->AvailableForStates(G4State_PreInit,G4State_Idle);
+  shellSpacing->SetToBeBroadcasted(false);
+
+  shellNumber = new G4UIcmdWithAnInteger("/det/shells/number",this);
+  shellNumber->SetGuidance("Set the number of shells");
+  shellNumber->SetParameterName("number",false);
+  shellNumber->SetRange("number>0");
+  shellNumber->AvailableForStates(G4State_PreInit,G4State_Idle);
+  shellNumber->SetToBeBroadcasted(false);
+
+  shellLength = new G4UIcmdWithADoubleAndUnit("/det/shells/length",this);
+  shellLength->SetGuidance("Set the length of the shells along z, centred on z = 0");
+  shellLength->SetParameterName("length",false);
+  shellLength->SetRange("length>0.");
+  shellLength->SetDefaultUnit("micrometer");
+  shellLength->AvailableForStates(G4State_PreInit,G4State_Idle);
+  shellLength->SetToBeBroadcasted(false);
+
+  limitsDir = new G4UIdirectory("/det/limits/");
+  limitsDir->SetGuidance("User limits per volume class (voxel, water, world),");
+  limitsDir->SetGuidance("enforced by the step limiter and special cuts; may be changed between runs");
+
+  maxStep = MakeLimitCommand("maxStep", "Maximum step length", "nm", "Length");
+  maxTrackLength = MakeLimitCommand("maxTrackLength", "Kill tracks whose total length exceeds this", "um", "Length");
+  maxTime = MakeLimitCommand("maxTime", "Kill tracks whose global time exceeds this", "ns", "Time");
+  minEkin = MakeLimitCommand("minEkin", "Kill tracks whose kinetic energy falls below this", "eV", "Energy");
   
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
+G4UIcommand *DetectorMessenger::MakeLimitCommand(const char *name, const char *guidance,
+                                                 const char *defaultUnit, const char *unitCategory)
+{
+  G4UIcommand *command = new G4UIcommand((G4String("/det/limits/") + name).c_str(), this);
+  command->SetGuidance(guidance);
+
+  G4UIparameter *volume = new G4UIparameter("volume", 's', false);
+  volume->SetParameterCandidates("voxel water world");
+  command->SetParameter(volume);
+
+  G4UIparameter *value = new G4UIparameter("value", 'd', false);
+  value->SetParameterRange("value>=0.");
+  command->SetParameter(value);
+
+  G4UIparameter *unit = new G4UIparameter("unit", 's', true);
+  unit->SetDefaultValue(defaultUnit);
+  unit->SetParameterCandidates(G4UIcommand::UnitsList(unitCategory));
+  command->SetParameter(unit);
+
+  command->AvailableForStates(G4State_PreInit,G4State_Idle);
+  command->SetToBeBroadcasted(false);
+  return command;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
 DetectorMessenger::~DetectorMessenger()
 {
 
@@ -98,6 +264,27 @@ delete spacing;
 delete start_Z;
 delete ndiv_Y;
 delete ndiv_Z;
+delete layout;
+delete benchmarkNavigation;
+delete benchmarkStepping;
+delete placement;
+delete cellNumber;
+delete cellShape;
+delete cellSlab;
+delete cellSphere;
+delete cellSeed;
+delete cellFile;
+delete cellsDir;
+delete shellRMin;
+delete shellSpacing;
+delete shellNumber;
+delete shellLength;
+delete shellsDir;
+delete maxStep;
+delete maxTrackLength;
+delete maxTime;
+delete minEkin;
+delete limitsDir;
 
 }
 
@@ -124,6 +311,85 @@ void DetectorMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
   if (command == start_Z)
   {
      fDetector->set_startZ(start_Z->GetNewDoubleValue(newValue));
+  }
+  if (command == layout)
+  {
+     fDetector->set_layout(newValue);
+  }
+  if (command == benchmarkNavigation)
+  {
+     fDetector->benchmark_navigation(benchmarkNavigation->GetNewIntValue(newValue));
+  }
+#ifdef ALPHABEAM_STEPPING_BENCHMARK
+  if (command == benchmarkStepping)
+  {
+     SteppingBenchmark::Request(benchmarkStepping->GetNewIntValue(newValue));
+  }
+#endif
+  if (command == placement)
+  {
+     fDetector->set_placement(newValue);
+  }
+  if (command == cellNumber || command == cellShape || command == cellSlab || command == cellSphere ||
+      command == cellSeed)
+  {
+     CellPacking::Spec spec = fDetector->get_cellSpec();
+     if (command == cellNumber)
+       spec.numCells = cellNumber->GetNewIntValue(newValue);
+     else if (command == cellShape)
+       spec.shape = (newValue == "orb") ? CellPacking::kOrb : CellPacking::kBox;
+     else if (command == cellSlab)
+     {
+       std::istringstream is(newValue);
+       G4String unit;
+       is >> spec.halfWidth >> spec.thickness >> unit;
+       spec.halfWidth *= G4UIcommand::ValueOf(unit);
+       spec.thickness *= G4UIcommand::ValueOf(unit);
+       spec.region = CellPacking::kSlab;
+     }
+     else if (command == cellSphere)
+     {
+       spec.radius = cellSphere->GetNewDoubleValue(newValue);
+       spec.region = CellPacking::kSphere;
+     }
+     else
+       spec.seed = cellSeed->GetNewIntValue(newValue);
+     fDetector->set_cellSpec(spec);
+  }
+  if (command == cellFile)
+  {
+     fDetector->set_cellFile(newValue);
+  }
+  if (command == shellRMin || command == shellSpacing || command == shellNumber || command == shellLength)
+  {
+     DetectorConstruction::ShellSpec spec = fDetector->get_shellSpec();
+     if (command == shellRMin)
+       spec.rMin = shellRMin->GetNewDoubleValue(newValue);
+     else if (command == shellSpacing)
+       spec.spacing = shellSpacing->GetNewDoubleValue(newValue);
+     else if (command == shellNumber)
+       spec.number = shellNumber->GetNewIntValue(newValue);
+     else
+       spec.length = shellLength->GetNewDoubleValue(newValue);
+     fDetector->set_shellSpec(spec);
+  }
+  if (command == maxStep || command == maxTrackLength || command == maxTime || command == minEkin)
+  {
+     std::istringstream is(newValue);
+     G4String volume, unit;
+     G4double value;
+     is >> volume >> value >> unit;
+     value *= G4UIcommand::ValueOf(unit);
+
+     G4UserLimits *limits = fDetector->get_userLimits(DetectorConstruction::ParseVolumeClass(volume));
+     if (command == maxStep)
+       limits->SetMaxAllowedStep(value);
+     else if (command == maxTrackLength)
+       limits->SetUserMaxTrackLength(value);
+     else if (command == maxTime)
+       limits->SetUserMaxTime(value);
+     else
+       limits->SetUserMinEkine(value);
   }}
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
\ No newline at end of file
@@ -39,7 +39,10 @@
 #include "Randomize.hh"
 #include "G4RunManager.hh"
 #include "RunAction.hh"
+#include "PhaseSpaceWriter.hh"
 #include "CommandLineParser.hh"
+#include "RecordConsumerSet.hh"
+#include "SteppingBenchmark.hh"
 
 using namespace G4DNAPARSER;
 
@@ -48,7 +51,7 @@ using namespace G4DNAPARSER;
 
 EventAction::EventAction() : G4UserEventAction()
 {
-
+  fTelemetry = Telemetry::GetThreadCounters();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -61,12 +64,54 @@ EventAction::~EventAction()
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EventAction::BeginOfEventAction(const G4Event *)
+void EventAction::BeginOfEventAction(const G4Event *event)
 {
+  auto runAction = (RunAction *)G4RunManager::GetRunManager()->GetUserRunAction();
+  runAction->BeginOfEvent();
+  if (EventWatchdog::Monitor *watchdog = runAction->GetWatchdog())
+    watchdog->BeginOfEvent(event->GetEventID());
+  if (fTelemetry)
+    fTelemetry->eventStart.store(Telemetry::Now(), std::memory_order_relaxed);
+#ifdef ALPHABEAM_STEPPING_BENCHMARK
+  // /det/benchmarkStepping, on this thread's RunAction and in an event
+  SteppingBenchmark::RunIfRequested();
+#endif
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
-void EventAction::EndOfEventAction(const G4Event *)
+void EventAction::EndOfEventAction(const G4Event *event)
 {
+  auto runAction = (RunAction *)G4RunManager::GetRunManager()->GetUserRunAction();
+  runAction->EndOfEvent();
+  EventWatchdog::Monitor *watchdog = runAction->GetWatchdog();
+  if (watchdog)
+    watchdog->EndOfEvent();
+  if (RecordAndKill::Policy *kill = runAction->GetRecordAndKill())
+    kill->EndOfEvent();
+  RecordConsumerSet *consumers = runAction->GetRecordConsumers();
+  // aborted: e.g. the event after the last one of a -replay list. Events
+  // skipped by the watchdog keep the records they made before the abort.
+  if (event->IsAborted() && !(watchdog && watchdog->IsCurrentEventSkipped()))
+  {
+    if (consumers)
+      consumers->Flush();
+  }
+  else
+  {
+    if (PhaseSpaceWriter *psWriter = runAction->GetPhaseSpaceWriter())
+      psWriter->EndOfEvent(event->GetEventID());
+    if (consumers)
+      consumers->EndOfEvent(event->GetEventID());
+  }
+  // everything of this event allocated from the arena goes at once
+  runAction->GetEventArena().Reset();
+
+  if (fTelemetry)
+  {
+    Telemetry::Counters::Add(fTelemetry->events);
+    fTelemetry->eventStart.store(0, std::memory_order_relaxed);
+    if (PhaseSpaceWriter *psWriter = runAction->GetPhaseSpaceWriter())
+      fTelemetry->psBytes.store(psWriter->GetBytesWritten(), std::memory_order_relaxed);
+  }
 }
@@ -0,0 +1,137 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventArena.cc
+/// \brief Implementation of the EventArena class
+
+#include "EventArena.hh"
+#include <algorithm>
+#include <cstdlib>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+EventArena::EventArena(std::size_t chunkSize)
+    : fChunkSize(chunkSize)
+{
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+EventArena::~EventArena()
+{
+    for (auto &chunk : fChunks)
+        ::operator delete(chunk.data);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void *EventArena::AllocateSlow(std::size_t size, std::size_t alignment)
+{
+    // the current chunk is full: move on to the next one that fits, or
+    // add one (operator new aligns to max_align_t)
+    while (++fCurrent < fChunks.size())
+    {
+        if (size <= fChunks[fCurrent].size)
+        {
+            fOffset = size;
+            return fChunks[fCurrent].data;
+        }
+    }
+
+    Chunk chunk;
+    chunk.size = std::max(fChunkSize, size + alignment);
+    chunk.data = (char *)::operator new(chunk.size);
+    fChunks.push_back(chunk);
+    fCurrent = fChunks.size() - 1;
+    fOffset = size;
+    fHeldBytes += chunk.size;
+
+    ++fNumChunkAllocations;
+    if (fNumEvents > 0)
+        ++fNumLateChunkAllocations;
+    return chunk.data;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::size_t EventArena::UsedBytes() const
+{
+    std::size_t used = fOffset;
+    for (std::size_t i = 0; i < fCurrent && i < fChunks.size(); i++)
+        used += fChunks[i].size;
+    return used;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventArena::Reset()
+{
+    std::size_t used = UsedBytes();
+    fTotalBytes += used;
+    fPeakEventBytes = std::max(fPeakEventBytes, used);
+    ++fNumEvents;
+    fCurrent = 0;
+    fOffset = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventArena::ResetStatistics()
+{
+    // the chunks are kept for the next run
+    fNumEvents = fNumObjects = fNumChunkAllocations = fNumLateChunkAllocations = 0;
+    fTotalBytes = 0;
+    fPeakEventBytes = 0;
+    fHeldBytes = 0;
+    for (const auto &chunk : fChunks)
+        fHeldBytes += chunk.size;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventArena::MergeStatistics(const EventArena &other)
+{
+    fNumEvents += other.fNumEvents;
+    fNumObjects += other.fNumObjects;
+    fNumChunkAllocations += other.fNumChunkAllocations;
+    fNumLateChunkAllocations += other.fNumLateChunkAllocations;
+    fTotalBytes += other.fTotalBytes;
+    fPeakEventBytes = std::max(fPeakEventBytes, other.fPeakEventBytes);
+    fHeldBytes += other.fHeldBytes;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventArena::PrintStatistics() const
+{
+    if (fNumObjects == 0)
+        return;
+
+    G4cout << "Event arena: " << fNumObjects << " allocations in " << fNumEvents << " events, "
+           << (fNumEvents > 0 ? fTotalBytes / fNumEvents : 0.) / 1024 << " kB per event (peak "
+           << fPeakEventBytes / 1024 << " kB), " << fNumChunkAllocations << " chunks from the heap ("
+           << fNumLateChunkAllocations << " after the first event), " << fHeldBytes / 1024 << " kB held" << G4endl;
+}
@@ -0,0 +1,114 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventSeed.cc
+/// \brief Implementation of the EventSeed class
+
+#include "EventSeed.hh"
+#include "Randomize.hh"
+#include <cctype>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <sstream>
+
+G4long EventSeed::fgMasterSeed = 1;
+
+namespace
+{
+// splitmix64 finaliser
+std::uint64_t Mix(std::uint64_t x)
+{
+  x += 0x9e3779b97f4a7c15ULL;
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+// an event ID spanning the whole of text
+G4bool ParseEventID(const std::string &text, G4int &id)
+{
+  if (text.empty() || !std::isdigit((unsigned char)text[0]))
+    return false;
+  char *end;
+  long value = std::strtol(text.c_str(), &end, 10);
+  if (*end != '\0' || value > INT_MAX)
+    return false;
+  id = (G4int)value;
+  return true;
+}
+
+void EventListError(const G4String &list, const std::string &item, const char *reason)
+{
+  G4ExceptionDescription msg;
+  msg << reason << " '" << item << "' in event list '" << list << "', expected IDs and ranges like 57,1200-1203";
+  G4Exception("EventSeed::ParseEventList", "EventSeed001", FatalException, msg);
+}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventSeed::Apply(G4int eventID)
+{
+  std::uint64_t hash = Mix(Mix((std::uint64_t)fgMasterSeed) ^ (std::uint32_t)eventID);
+
+  // two positive 31-bit seeds; the list is zero-terminated, so never 0
+  long seeds[3];
+  seeds[0] = (long)((hash & 0x7fffffff) | 1);
+  seeds[1] = (long)(((hash >> 32) & 0x7fffffff) | 1);
+  seeds[2] = 0;
+  G4Random::setTheSeeds(seeds, -1);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::vector<G4int> EventSeed::ParseEventList(const G4String &list)
+{
+  std::vector<G4int> ids;
+  std::istringstream is(list);
+  std::string item;
+  while (std::getline(is, item, ','))
+  {
+    if (item.empty())
+      continue;
+    std::size_t dash = item.find('-');
+    G4int first, last;
+    if (!ParseEventID(item.substr(0, dash), first) ||
+        !ParseEventID(dash == std::string::npos ? item : item.substr(dash + 1), last))
+    {
+      EventListError(list, item, "bad event ID or range");
+      continue;
+    }
+    if (last < first)
+    {
+      EventListError(list, item, "reversed range");
+      continue;
+    }
+    for (G4int id = first; id <= last; id++)
+      ids.push_back(id);
+  }
+  return ids;
+}
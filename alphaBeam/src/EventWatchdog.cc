@@ -0,0 +1,273 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventWatchdog.cc
+/// \brief Implementation of the EventWatchdog class
+
+#include "EventWatchdog.hh"
+#include "EventWatchdogMessenger.hh"
+#include "EventSeed.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4VProcess.hh"
+#include "G4RunManager.hh"
+#include "G4EventManager.hh"
+#include "G4StackManager.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+
+namespace
+{
+G4Mutex spoolMutex = G4MUTEX_INITIALIZER;
+
+// event time bins [s]: [0, 1 us), [1 us, 2 us), [2 us, 4 us), ...
+G4double BinLowerEdge(G4int bin)
+{
+  return bin == 0 ? 0. : std::ldexp(1e-6, bin - 1);
+}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+EventWatchdog *EventWatchdog::Instance()
+{
+  static EventWatchdog instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+EventWatchdog::EventWatchdog()
+{
+  fMessenger = new EventWatchdogMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+EventWatchdog::~EventWatchdog()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventWatchdog::SetAction(const G4String &name)
+{
+  if (name == "warn")
+    fAction = Action::Warn;
+  else if (name == "abort")
+    fAction = Action::Abort;
+  else if (name == "spool")
+    fAction = Action::Spool;
+  else
+  {
+    G4ExceptionDescription msg;
+    msg << "unknown watchdog action '" << name << "', expected warn, abort or spool";
+    G4Exception("EventWatchdog::SetAction", "Watchdog001", FatalException, msg);
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::unique_ptr<EventWatchdog::Monitor> EventWatchdog::CreateMonitor() const
+{
+  if (!IsEnabled())
+    return nullptr;
+  auto monitor = std::make_unique<Monitor>();
+  monitor->fMaxSeconds = fMaxTime / s;
+  monitor->fMaxSteps = fMaxSteps;
+  monitor->fAction = fAction;
+  monitor->fSpoolFile = fSpoolFile;
+  return monitor;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventWatchdog::Monitor::BeginOfEvent(G4int eventID)
+{
+  fEventID = eventID;
+  fSteps = 0;
+  fTripped = false;
+  fSkipped = false;
+  fEventStart = std::chrono::steady_clock::now();
+  SetNextCheck();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventWatchdog::Monitor::SetNextCheck()
+{
+  // the next step at which a budget may have run out
+  fNextCheck = fSteps + kTimeCheckSteps;
+  if (fMaxSeconds <= 0)
+    fNextCheck = LONG_MAX;
+  if (fMaxSteps > 0)
+    fNextCheck = std::min(fNextCheck, fMaxSteps);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool EventWatchdog::Monitor::Check(const G4Step *step)
+{
+  if (fTripped)
+    return fSkipped;
+
+  if (fMaxSteps > 0 && fSteps >= fMaxSteps)
+    Trip(step, "step");
+  else if (fMaxSeconds > 0 &&
+           std::chrono::duration<G4double>(std::chrono::steady_clock::now() - fEventStart).count() > fMaxSeconds)
+    Trip(step, "time");
+  else
+    SetNextCheck();
+  return fSkipped;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventWatchdog::Monitor::Trip(const G4Step *step, const char *budget)
+{
+  fTripped = true;
+  fNextCheck = LONG_MAX; // no more checks in this event
+
+  G4double seconds = std::chrono::duration<G4double>(std::chrono::steady_clock::now() - fEventStart).count();
+  const G4Track *track = step->GetTrack();
+  const G4VProcess *creator = track->GetCreatorProcess();
+  G4StackManager *stack = G4EventManager::GetEventManager()->GetStackManager();
+
+  G4ExceptionDescription msg;
+  msg << "event " << fEventID << " exceeded its " << budget << " budget after " << fSteps
+      << " steps and " << seconds << " s" << G4endl
+      << "  re-simulate with: -seed " << EventSeed::GetMasterSeed() << " -replay " << fEventID << G4endl
+      << "  current track " << track->GetTrackID() << " (parent " << track->GetParentID() << "): "
+      << track->GetParticleDefinition()->GetParticleName() << ", "
+      << G4BestUnit(track->GetKineticEnergy(), "Energy") << ", in "
+      << (track->GetVolume() ? track->GetVolume()->GetName() : G4String("nowhere")) << ", created by "
+      << (creator ? creator->GetProcessName() : G4String("primary")) << ", " << track->GetCurrentStepNumber()
+      << " steps" << G4endl
+      << "  " << stack->GetNUrgentTrack() << " urgent and " << stack->GetNWaitingTrack()
+      << " waiting tracks stacked" << G4endl;
+
+  if (fAction == Action::Warn)
+  {
+    msg << "  continuing (/watchdog/action warn)";
+    G4Exception("EventWatchdog::Monitor", "Watchdog002", JustWarning, msg);
+    return;
+  }
+
+  msg << "  event aborted and listed in the Skipped column of Info";
+  if (fAction == Action::Spool)
+  {
+    msg << " and in " << fSpoolFile;
+    G4AutoLock lock(&spoolMutex);
+    std::ofstream spool(fSpoolFile, std::ios::app);
+    spool << fEventID << G4endl;
+  }
+  G4Exception("EventWatchdog::Monitor", "Watchdog003", JustWarning, msg);
+
+  fSkipped = true;
+  fSkippedEvents.push_back(fEventID);
+  // marks the event aborted and kills the current track and the stack
+  G4RunManager::GetRunManager()->AbortEvent();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventWatchdog::Monitor::EndOfEvent()
+{
+  G4double seconds = std::chrono::duration<G4double>(std::chrono::steady_clock::now() - fEventStart).count();
+  G4int bin = 0;
+  if (seconds >= 1e-6)
+    bin = std::min(kNumTimeBins - 1, 1 + (G4int)std::log2(seconds * 1e6));
+  fTimeBins[bin]++;
+  fNumEvents++;
+  fTotalSeconds += seconds;
+  if (seconds > fSlowestSeconds)
+  {
+    fSlowestSeconds = seconds;
+    fSlowestEvent = fEventID;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventWatchdog::Monitor::Merge(const Monitor &other)
+{
+  fSkippedEvents.insert(fSkippedEvents.end(), other.fSkippedEvents.begin(), other.fSkippedEvents.end());
+  fNumEvents += other.fNumEvents;
+  for (G4int bin = 0; bin < kNumTimeBins; bin++)
+    fTimeBins[bin] += other.fTimeBins[bin];
+  fTotalSeconds += other.fTotalSeconds;
+  if (other.fSlowestSeconds > fSlowestSeconds)
+  {
+    fSlowestSeconds = other.fSlowestSeconds;
+    fSlowestEvent = other.fSlowestEvent;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void EventWatchdog::Monitor::Print() const
+{
+  if (fNumEvents == 0)
+    return;
+
+  G4cout << "Event wall time (" << fNumEvents << " events): mean "
+         << G4BestUnit(fTotalSeconds / fNumEvents * s, "Time") << ", slowest event " << fSlowestEvent
+         << " " << G4BestUnit(fSlowestSeconds * s, "Time") << G4endl;
+
+  // percentiles as the upper edge of the bin they fall in
+  const G4double fractions[] = {0.5, 0.9, 0.99};
+  G4cout << " ";
+  for (G4double fraction : fractions)
+  {
+    G4long below = 0;
+    G4int bin = 0;
+    while (bin < kNumTimeBins - 1 && (below += fTimeBins[bin]) < fraction * fNumEvents)
+      bin++;
+    G4cout << " p" << (G4int)(fraction * 100) << " < " << G4BestUnit(BinLowerEdge(bin + 1) * s, "Time");
+  }
+  G4cout << G4endl;
+
+  for (G4int bin = 0; bin < kNumTimeBins; bin++)
+    if (fTimeBins[bin] > 0)
+      G4cout << "  [" << G4BestUnit(BinLowerEdge(bin) * s, "Time") << ", "
+             << G4BestUnit(BinLowerEdge(bin + 1) * s, "Time") << "): " << fTimeBins[bin] << G4endl;
+
+  if (!fSkippedEvents.empty())
+  {
+    std::vector<G4int> skipped = fSkippedEvents;
+    std::sort(skipped.begin(), skipped.end());
+    G4cout << "  " << skipped.size() << " events skipped by the watchdog:";
+    for (G4int eventID : skipped)
+      G4cout << " " << eventID;
+    G4cout << G4endl;
+  }
+}
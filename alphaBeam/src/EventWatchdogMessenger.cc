@@ -0,0 +1,100 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file EventWatchdogMessenger.cc
+/// \brief Implementation of the EventWatchdogMessenger class
+
+#include "EventWatchdogMessenger.hh"
+
+#include "EventWatchdog.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithAnInteger.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventWatchdogMessenger::EventWatchdogMessenger(EventWatchdog *watchdog)
+    : G4UImessenger(), fWatchdog(watchdog)
+{
+  fWatchdogDir = new G4UIdirectory("/watchdog/");
+  fWatchdogDir->SetGuidance("Per-event wall-time and step budgets");
+
+  fMaxTimeCmd = new G4UIcmdWithADoubleAndUnit("/watchdog/maxTime",this);
+  fMaxTimeCmd->SetGuidance("Wall-time budget of one event, 0 for none");
+  fMaxTimeCmd->SetParameterName("time",false);
+  fMaxTimeCmd->SetRange("time>=0.");
+  fMaxTimeCmd->SetUnitCategory("Time");
+  fMaxTimeCmd->SetDefaultUnit("s");
+  fMaxTimeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fMaxTimeCmd->SetToBeBroadcasted(false);
+
+  fMaxStepsCmd = new G4UIcmdWithAnInteger("/watchdog/maxSteps",this);
+  fMaxStepsCmd->SetGuidance("Step budget of one event, 0 for none");
+  fMaxStepsCmd->SetParameterName("steps",false);
+  fMaxStepsCmd->SetRange("steps>=0");
+  fMaxStepsCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fMaxStepsCmd->SetToBeBroadcasted(false);
+
+  fActionCmd = new G4UIcmdWithAString("/watchdog/action",this);
+  fActionCmd->SetGuidance("On an exceeded budget: warn (log only), abort (skip the event)");
+  fActionCmd->SetGuidance("or spool (skip it and append its eventID to the spool file)");
+  fActionCmd->SetParameterName("action",false);
+  fActionCmd->SetCandidates("warn abort spool");
+  fActionCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fActionCmd->SetToBeBroadcasted(false);
+
+  fSpoolFileCmd = new G4UIcmdWithAString("/watchdog/spoolFile",this);
+  fSpoolFileCmd->SetGuidance("File the IDs of spooled events are appended to");
+  fSpoolFileCmd->SetParameterName("fileName",false);
+  fSpoolFileCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fSpoolFileCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+EventWatchdogMessenger::~EventWatchdogMessenger()
+{
+  delete fMaxTimeCmd;
+  delete fMaxStepsCmd;
+  delete fActionCmd;
+  delete fSpoolFileCmd;
+  delete fWatchdogDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void EventWatchdogMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
+{
+  if (command == fMaxTimeCmd)
+    fWatchdog->SetMaxTime(fMaxTimeCmd->GetNewDoubleValue(newValue));
+  if (command == fMaxStepsCmd)
+    fWatchdog->SetMaxSteps(fMaxStepsCmd->GetNewIntValue(newValue));
+  if (command == fActionCmd)
+    fWatchdog->SetAction(newValue);
+  if (command == fSpoolFileCmd)
+    fWatchdog->SetSpoolFile(newValue);
+}
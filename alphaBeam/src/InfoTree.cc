@@ -0,0 +1,68 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file InfoTree.cc
+/// \brief Implementation of WriteInfoTree
+
+#include "InfoTree.hh"
+
+#ifdef ALPHABEAM_WITH_ROOT
+
+#include "G4SystemOfUnits.hh"
+#include "TFile.h"
+#include "TTree.h"
+#include <cstdint>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void WriteInfoTree(TFile *file, const RunInfo &info)
+{
+  file->cd();
+
+  // owned and deleted by file
+  TTree *infoTree = new TTree("Info", "Info");
+  std::int32_t primaries = info.numPrimaries;
+  char hash[64] = {0};
+  info.gitHash.copy(hash, sizeof(hash) - 1);
+  G4double efficiency = info.geometricEfficiency;
+  Long64_t seed = info.masterSeed;
+  std::vector<int> skipped(info.skippedEvents.begin(), info.skippedEvents.end());
+  G4double rMin = info.rMin / um;
+  G4double rMax = info.rMax / um;
+  std::vector<int> cellsPerShell(info.cellsPerShell.begin(), info.cellsPerShell.end());
+  infoTree->Branch("NumPrimaries", &primaries, "NumPrimaries/I");
+  infoTree->Branch("GitHash", hash, "GitHash/C");
+  infoTree->Branch("GeometricEfficiency", &efficiency, "GeometricEfficiency/D");
+  infoTree->Branch("Seed", &seed, "Seed/L");
+  infoTree->Branch("Skipped", &skipped);
+  infoTree->Branch("Rmin_um", &rMin, "Rmin_um/D");
+  infoTree->Branch("Rmax_um", &rMax, "Rmax_um/D");
+  infoTree->Branch("NumCells", &cellsPerShell);
+  infoTree->Fill();
+  infoTree->Write();
+}
+
+#endif
@@ -0,0 +1,81 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file NavigationBenchmark.cc
+/// \brief Implementation of the NavigationBenchmark class
+
+#include "NavigationBenchmark.hh"
+#include "DetectorConstruction.hh"
+#include "G4Navigator.hh"
+#include "G4VPhysicalVolume.hh"
+#include "Randomize.hh"
+#include <chrono>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+NavigationBenchmark::Result NavigationBenchmark::Run(G4VPhysicalVolume *world, const DetectorConstruction &detector,
+                                                     G4int numRays)
+{
+  // a private navigator, so the tracking navigator's state is left alone
+  G4Navigator navigator;
+  navigator.SetWorldVolume(world);
+
+  // start points cover the lattice plus one spacing of water around it
+  G4ThreeVector margin(detector.get_spacing(), detector.get_spacing(), detector.get_spacing());
+  G4ThreeVector lo = detector.get_lattice().GetMin() - margin;
+  G4ThreeVector hi = detector.get_lattice().GetMax() + margin;
+
+  Result result;
+  auto start = std::chrono::steady_clock::now();
+  for (G4int ray = 0; ray < numRays; ray++)
+  {
+    G4ThreeVector position(lo.x() + G4UniformRand()*(hi.x() - lo.x()),
+                           lo.y() + G4UniformRand()*(hi.y() - lo.y()),
+                           lo.z() + G4UniformRand()*(hi.z() - lo.z()));
+    G4double cosTheta = 2*G4UniformRand() - 1;
+    G4double sinTheta = std::sqrt(1 - cosTheta*cosTheta);
+    G4double phi = CLHEP::twopi*G4UniformRand();
+    G4ThreeVector direction(sinTheta*std::cos(phi), sinTheta*std::sin(phi), cosTheta);
+
+    navigator.LocateGlobalPointAndSetup(position, &direction, false, false);
+    while (position.x() >= lo.x() && position.x() <= hi.x() &&
+           position.y() >= lo.y() && position.y() <= hi.y() &&
+           position.z() >= lo.z() && position.z() <= hi.z())
+    {
+      G4double safety = 0;
+      G4double step = navigator.ComputeStep(position, direction, kInfinity, safety);
+      if (step == kInfinity)
+        break;
+      position += step*direction;
+      navigator.SetGeometricallyLimitedStep();
+      if (navigator.LocateGlobalPointAndSetup(position, &direction, true) == nullptr)
+        break;
+      result.numSteps++;
+    }
+  }
+  result.seconds = std::chrono::duration<G4double>(std::chrono::steady_clock::now() - start).count();
+  return result;
+}
@@ -0,0 +1,234 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file ParameterSweep.cc
+/// \brief Implementation of the ParameterSweep class
+
+#include "ParameterSweep.hh"
+#include "G4RunManager.hh"
+#include "G4UImanager.hh"
+#include "G4UIcommandStatus.hh"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+G4String ParameterSweep::fgCurrentTag;
+
+namespace
+{
+void SweepError(const G4String &fileName, const G4String &line, const G4String &reason)
+{
+  G4ExceptionDescription msg;
+  msg << fileName << ": " << reason << " in line '" << line << "'";
+  G4Exception("ParameterSweep::ParameterSweep", "ParameterSweep001", FatalException, msg);
+}
+
+// splits "0.5um" into "0.5" and "um"
+void SplitNumber(const G4String &text, G4String &number, G4String &unit)
+{
+  const char *begin = text.c_str();
+  char *end;
+  std::strtod(begin, &end);
+  number = text.substr(0, end - begin);
+  unit = text.substr(end - begin);
+}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+ParameterSweep::ParameterSweep(const G4String &fileName)
+{
+  std::ifstream file(fileName);
+  if (!file)
+  {
+    G4ExceptionDescription msg;
+    msg << "cannot open sweep file " << fileName;
+    G4Exception("ParameterSweep::ParameterSweep", "ParameterSweep000", FatalException, msg);
+    return;
+  }
+
+  std::vector<Configuration> axes;   // grid mode: all values of one parameter
+  G4bool listMode = false;
+  G4String line;
+  while (std::getline(file, line))
+  {
+    G4StrUtil::strip(line);
+    if (line.empty() || line[0] == '#')
+      continue;
+
+    std::istringstream is(line);
+    G4String first;
+    is >> first;
+    if (first == "events")
+    {
+      if (!(is >> fNumEvents) || fNumEvents <= 0)
+        SweepError(fileName, line, "bad number of events");
+      continue;
+    }
+
+    if (first.find('=') != std::string::npos)
+    {
+      // list: parameter=value ...
+      listMode = true;
+      Configuration configuration;
+      G4String token = first;
+      do
+      {
+        std::size_t pos = token.find('=');
+        if (pos == std::string::npos)
+          SweepError(fileName, line, "expected parameter=value");
+        G4String parameter = token.substr(0, pos);
+        if (GetCommand(parameter).empty())
+          SweepError(fileName, line, "unknown parameter " + parameter);
+        // layout takes a name, the others a number with an optional unit
+        G4String number = token.substr(pos + 1), unit;
+        if (parameter != "layout")
+          SplitNumber(token.substr(pos + 1), number, unit);
+        if (number.empty())
+          SweepError(fileName, line, "bad value for " + parameter);
+        configuration.emplace_back(parameter, FormatValue(parameter, number, unit));
+      } while (is >> token);
+      fConfigurations.push_back(configuration);
+      continue;
+    }
+
+    // grid axis: parameter value ... [unit]
+    if (GetCommand(first).empty())
+      SweepError(fileName, line, "unknown parameter " + first);
+    std::vector<G4String> values;
+    G4String token;
+    while (is >> token)
+      values.push_back(token);
+    G4String unit;
+    if (!values.empty() && first != "layout" && std::isalpha((unsigned char)values.back()[0]))
+    {
+      unit = values.back();
+      values.pop_back();
+    }
+    if (values.empty())
+      SweepError(fileName, line, "no values");
+
+    Configuration axis;
+    for (const auto &value : values)
+      axis.emplace_back(first, FormatValue(first, value, unit));
+    axes.push_back(axis);
+  }
+
+  if (listMode && !axes.empty())
+    SweepError(fileName, "", "grid and list lines mixed");
+
+  if (!listMode)
+  {
+    // Cartesian product, the last axis varying fastest
+    fConfigurations.assign(1, Configuration());
+    for (const auto &axis : axes)
+    {
+      std::vector<Configuration> product;
+      for (const auto &configuration : fConfigurations)
+        for (const auto &setting : axis)
+        {
+          product.push_back(configuration);
+          product.back().push_back(setting);
+        }
+      fConfigurations.swap(product);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4String ParameterSweep::GetCommand(const G4String &parameter)
+{
+  if (parameter == "spacing")
+    return "/det/set_spacing";
+  if (parameter == "startZ")
+    return "/det/set_startZ";
+  if (parameter == "ndiv_X" || parameter == "ndiv_Y" || parameter == "ndiv_Z")
+    return "/det/set_" + parameter;
+  if (parameter == "layout")
+    return "/det/layout";
+  return "";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4String ParameterSweep::FormatValue(const G4String &parameter, const G4String &number, const G4String &unit)
+{
+  if (parameter == "spacing" || parameter == "startZ")
+    return number + " " + (unit.empty() ? G4String("um") : unit);
+  return number;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4String ParameterSweep::MakeTag(const Configuration &configuration)
+{
+  G4String tag;
+  for (const auto &setting : configuration)
+  {
+    G4String value = setting.second;
+    value.erase(std::remove(value.begin(), value.end(), ' '), value.end());
+    tag += "_" + setting.first + value;
+  }
+  return tag;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void ParameterSweep::Run()
+{
+  G4UImanager *UImanager = G4UImanager::GetUIpointer();
+  G4RunManager *runManager = G4RunManager::GetRunManager();
+
+  G4int index = 0;
+  for (const auto &configuration : fConfigurations)
+  {
+    // a rejected setting would run the previous geometry under this tag
+    for (const auto &setting : configuration)
+    {
+      G4String command = GetCommand(setting.first) + " " + setting.second;
+      if (UImanager->ApplyCommand(command) != fCommandSucceeded)
+      {
+        G4ExceptionDescription msg;
+        msg << "command '" << command << "' failed, configuration " << MakeTag(configuration) << " not run";
+        G4Exception("ParameterSweep::Run", "ParameterSweep001", FatalException, msg);
+        return;
+      }
+    }
+
+    fgCurrentTag = MakeTag(configuration);
+    G4cout << "Sweep configuration " << ++index << "/" << fConfigurations.size() << ": " << fgCurrentTag << G4endl;
+
+    auto start = std::chrono::steady_clock::now();
+    runManager->BeamOn(fNumEvents);
+    std::chrono::duration<G4double> elapsed = std::chrono::steady_clock::now() - start;
+    G4cout << "Sweep configuration " << fgCurrentTag << " done in " << elapsed.count() << " s" << G4endl;
+  }
+  fgCurrentTag.clear();
+}
@@ -0,0 +1,146 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+//
+/// \file ParticleSpecies.cc
+/// \brief Implementation of the ParticleSpecies class
+
+#include "ParticleSpecies.hh"
+#include "CommandLineParser.hh"
+#include "G4Alpha.hh"
+#include "G4Electron.hh"
+#include "G4Exception.hh"
+#include "G4Gamma.hh"
+#include "G4Proton.hh"
+#include <sstream>
+
+using namespace G4DNAPARSER;
+
+namespace
+{
+const char *const kNames[] = {"", "e-", "gamma", "alpha", "proton", "ion", "other"};
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4int ParticleSpecies::GetID(const G4ParticleDefinition *particle)
+{
+  // pointer tests first, they cover nearly every step
+  if (particle == G4Electron::Definition())
+    return kElectron;
+  if (particle == G4Gamma::Definition())
+    return kGamma;
+  if (particle == G4Alpha::Definition())
+    return kAlpha;
+  if (particle == G4Proton::Definition())
+    return kProton;
+  if (particle->GetParticleType() == "nucleus")
+    return kIon;
+  return kOther;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+const char *ParticleSpecies::GetName(G4int id)
+{
+  return (id > 0 && id < kNumIDs) ? kNames[id] : "";
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4int ParticleSpecies::FindID(const G4String &name)
+{
+  for (G4int id = 1; id < kNumIDs; id++)
+    if (name == kNames[id])
+      return id;
+  return 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4int ParticleSpecies::ParseMask(const G4String &names)
+{
+  G4int mask = 0;
+  std::istringstream is(names);
+  std::string name;
+  while (std::getline(is, name, ','))
+  {
+    if (name == "all")
+    {
+      mask |= (1 << kNumIDs) - 2;
+      continue;
+    }
+    G4int id = FindID(name);
+    if (id == 0)
+    {
+      G4ExceptionDescription description;
+      description << "Unknown species \"" << name
+                  << "\", use e-, gamma, alpha, proton, ion, other or all." << G4endl;
+      G4Exception("ParticleSpecies::ParseMask", "ParticleSpecies001", FatalException, description);
+      continue;
+    }
+    mask |= 1 << id;
+  }
+  return mask;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4int ParticleSpecies::GetRecordedMask()
+{
+  Command *command = CommandLineParser::GetParser()->GetCommandIfActive("-species");
+  return command ? ParseMask(command->GetOption()) : kDefaultMask;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void ParticleSpecies::Merge(const ParticleSpecies &other)
+{
+  for (const auto &[particle, counts] : other.fSkipped)
+  {
+    Counts &total = fSkipped[particle];
+    total.entering += counts.entering;
+    total.created += counts.created;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void ParticleSpecies::Print() const
+{
+  if (fSkipped.empty())
+    return;
+
+  // by name, so the list reads the same in every run
+  std::map<G4String, Counts> byName;
+  for (const auto &[particle, counts] : fSkipped)
+    byName[particle->GetParticleName()] = counts;
+
+  G4cout << "Species reaching a voxel but not recorded (see -species):" << G4endl;
+  for (const auto &[name, counts] : byName)
+    G4cout << "  " << name << ": " << counts.entering << " entering, "
+           << counts.created << " created in a voxel" << G4endl;
+}
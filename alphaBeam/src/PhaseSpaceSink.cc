@@ -0,0 +1,213 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhaseSpaceSink.cc
+/// \brief Implementation of the PhaseSpaceSink class
+
+#include "PhaseSpaceSink.hh"
+#include "G4Exception.hh"
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+int PhaseSpaceSink::fgStdoutFd = -1;
+
+namespace
+{
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+class FileSink : public PhaseSpaceSink
+{
+public:
+  explicit FileSink(const G4String &name) : fName(name)
+  {
+    fFile.open(name, std::ios::out | std::ios::binary);
+  }
+  G4bool IsOpen() const { return fFile.is_open(); }
+
+  G4bool Write(const void *data, std::size_t size) override
+  {
+    fFile.write((const char *)data, size);
+    return (bool)fFile;
+  }
+  void Close() override { fFile.close(); }
+  const G4String &GetName() const override { return fName; }
+
+private:
+  G4String fName;
+  std::ofstream fFile;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+class DescriptorSink : public PhaseSpaceSink
+{
+public:
+  DescriptorSink(int fd, const G4String &name) : fFd(fd), fName(name) {}
+  ~DescriptorSink() override { Close(); }
+
+  G4bool Write(const void *data, std::size_t size) override
+  {
+    // blocking write: a slow consumer stalls transport here
+    const char *p = (const char *)data;
+    while (size > 0)
+    {
+      ssize_t n = ::write(fFd, p, size);
+      if (n < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        G4ExceptionDescription description;
+        description << "Writing to " << fName << " failed: " << std::strerror(errno) << G4endl;
+        G4Exception("PhaseSpaceSink::Write", "PhaseSpaceSink001", FatalException, description);
+        return false;
+      }
+      p += n;
+      size -= n;
+    }
+    return true;
+  }
+  void Close() override
+  {
+    if (fFd >= 0)
+      ::close(fFd);
+    fFd = -1;
+  }
+  const G4String &GetName() const override { return fName; }
+
+private:
+  int fFd;
+  G4String fName;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+int OpenFifo(const G4String &path)
+{
+  struct stat info;
+  if (::stat(path.c_str(), &info) != 0)
+  {
+    if (::mkfifo(path.c_str(), 0644) != 0)
+      return -1;
+  }
+  else if (!S_ISFIFO(info.st_mode))
+  {
+    // opening it would overwrite a regular file in place
+    G4cout << "\n---> PhaseSpaceSink: " << path << " exists and is not a fifo" << G4endl;
+    errno = EEXIST;
+    return -1;
+  }
+  G4cout << "\n----> Waiting for a reader on " << path << G4endl;
+  return ::open(path.c_str(), O_WRONLY);
+}
+
+int ConnectSocket(const G4String &path)
+{
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path))
+  {
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0)
+    return -1;
+  if (::connect(fd, (sockaddr *)&address, sizeof(address)) != 0)
+  {
+    ::close(fd);
+    return -1;
+  }
+  return fd;
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool PhaseSpaceSink::IsStream(const G4String &target)
+{
+  return G4StrUtil::starts_with(target, "fifo:") || G4StrUtil::starts_with(target, "unix:") ||
+         G4StrUtil::starts_with(target, "stdout:");
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void PhaseSpaceSink::ReserveStdout()
+{
+  if (fgStdoutFd >= 0)
+    return;
+  // keep the real stdout for records, send everything printed to stderr
+  std::fflush(stdout);
+  fgStdoutFd = ::dup(STDOUT_FILENO);
+  ::dup2(STDERR_FILENO, STDOUT_FILENO);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::unique_ptr<PhaseSpaceSink> PhaseSpaceSink::Create(const G4String &target)
+{
+  if (!IsStream(target))
+  {
+    auto sink = std::make_unique<FileSink>(target);
+    if (!sink->IsOpen())
+      return nullptr;
+    return sink;
+  }
+
+  // a consumer that goes away is reported by write(), not by a signal
+  std::signal(SIGPIPE, SIG_IGN);
+
+  G4String path = target.substr(target.find(':') + 1);
+  int fd = -1;
+  if (G4StrUtil::starts_with(target, "fifo:"))
+    fd = OpenFifo(path);
+  else if (G4StrUtil::starts_with(target, "unix:"))
+    fd = ConnectSocket(path);
+  else
+  {
+    ReserveStdout();
+    fd = fgStdoutFd;
+  }
+
+  if (fd < 0)
+  {
+    G4cout << "\n---> PhaseSpaceSink::Create(): cannot open " << target
+           << " (" << std::strerror(errno) << ")" << G4endl;
+    return nullptr;
+  }
+  return std::make_unique<DescriptorSink>(fd, target);
+}
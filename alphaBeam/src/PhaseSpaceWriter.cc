@@ -0,0 +1,296 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PhaseSpaceWriter.cc
+/// \brief Implementation of the PhaseSpaceWriter class
+
+#include "PhaseSpaceWriter.hh"
+#include "CompactRecordCodec.hh"
+#include "PhaseSpaceSink.hh"
+#include "VoxelEntryRecord.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Exception.hh"
+#include <cstring>
+
+#ifdef ALPHABEAM_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+namespace
+{
+// raw size of a compact block or of a float batch on a stream
+const std::size_t kBlockCapacity = 64 * 1024;
+const std::size_t kFloatRecordSize = 20 * sizeof(float);
+
+// the optional fields as header flag bits 1.. and stream format bits 8..
+const std::uint32_t kZlibFlag = 1;
+const std::uint32_t kFieldFlagShift = 1;
+const std::uint32_t kFieldFormatShift = 8;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+PhaseSpaceWriter::PhaseSpaceWriter(Format format, G4double voxelHalfSize, std::uint32_t fields)
+    : fFormat(format), fVoxelHalfSize(voxelHalfSize), fFields(fields)
+{
+#ifndef ALPHABEAM_WITH_ZLIB
+  if (fFormat == Format::CompactZlib)
+  {
+    G4Exception("PhaseSpaceWriter::PhaseSpaceWriter", "PhaseSpaceWriter001", JustWarning,
+                "Built without zlib, writing uncompressed compact blocks.");
+    fFormat = Format::Compact;
+  }
+#endif
+  if (fFormat != Format::Float)
+    fCodec = std::make_unique<CompactRecordCodec>(fVoxelHalfSize / mm, fFields & kLineage, fFields & kVoxel,
+                                                  fFields & kSpecies);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+PhaseSpaceWriter::~PhaseSpaceWriter()
+{
+  Close();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+PhaseSpaceWriter::Format PhaseSpaceWriter::ParseFormat(const G4String &name)
+{
+  if (name.empty() || name == "float")
+    return Format::Float;
+  if (name == "compact")
+    return Format::Compact;
+  if (name == "compact-zlib")
+    return Format::CompactZlib;
+
+  G4ExceptionDescription description;
+  description << "Unknown phase-space format \"" << name
+              << "\", use float, compact or compact-zlib." << G4endl;
+  G4Exception("PhaseSpaceWriter::ParseFormat", "PhaseSpaceWriter002",
+              FatalException, description);
+  return Format::Float;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool PhaseSpaceWriter::Open(const G4String &target)
+{
+  fSink = PhaseSpaceSink::Create(target);
+  if (!fSink)
+  {
+    G4cout << "\n---> PhaseSpaceWriter::Open(): cannot open " << target << G4endl;
+    return false;
+  }
+  fFramed = PhaseSpaceSink::IsStream(target);
+
+  fNumRecords = 0;
+  fBytesWritten = 0;
+  fBlockSize = 0;
+  fBlockRecords = 0;
+  if (fCodec)
+    fCodec->Reset();
+  if (fFramed || fFormat != Format::Float)
+    fBlock.resize(kBlockCapacity);
+
+  float halfSize = fVoxelHalfSize / mm;
+  if (fFramed)
+  {
+    std::uint8_t header[16] = {'A', 'B', 'P', 'S', 'S', '0', '0', '1'};
+    std::uint32_t format = (std::uint32_t)fFormat | (fFields << kFieldFormatShift);
+    std::memcpy(header + 8, &format, sizeof(format));
+    std::memcpy(header + 12, &halfSize, sizeof(halfSize));
+    WriteFrame(kHeaderFrame, header, sizeof(header));
+  }
+  else if (fFormat != Format::Float)
+  {
+    char magic[8] = {'A', 'B', 'P', 'S', 'C', '0', '0', '1'};
+    std::uint32_t flags = (fFormat == Format::CompactZlib ? kZlibFlag : 0) | (fFields << kFieldFlagShift);
+    fSink->Write(magic, sizeof(magic));
+    fSink->Write(&flags, sizeof(flags));
+    fSink->Write(&halfSize, sizeof(halfSize));
+    fBytesWritten += 16;
+  }
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void PhaseSpaceWriter::Write(const VoxelEntryRecord &record)
+{
+  fNumRecords++;
+
+  if (fFormat == Format::Float)
+  {
+    float output[20];
+    std::size_t n = 12;
+    output[0] = record.localPosition.x() / mm;
+    output[1] = record.localPosition.y() / mm;
+    output[2] = record.localPosition.z() / mm;
+    output[3] = record.direction.x();
+    output[4] = record.direction.y();
+    output[5] = record.direction.z();
+    output[6] = record.kineticEnergy / MeV;
+    output[7] = record.eventID;
+    output[8] = record.particleID;
+    output[9] = record.copyNo;
+    output[10] = record.globalTime / s;
+    output[11] = record.excitationEnergy;
+    if (fFields & kLineage)
+    {
+      output[n++] = record.trackID;
+      output[n++] = record.parentID;
+      output[n++] = record.entry;
+    }
+    if (fFields & kVoxel)
+    {
+      output[n++] = record.voxelI;
+      output[n++] = record.voxelJ;
+    }
+    if (fFields & kSpecies)
+    {
+      G4bool nucleus = record.pdg / 1000000000 != 0;
+      output[n++] = nucleus ? 0 : record.pdg;
+      output[n++] = nucleus ? record.pdg / 10000 % 1000 : 0;
+      output[n++] = nucleus ? record.pdg / 10 % 1000 : 0;
+    }
+    std::size_t size = n * sizeof(float);
+
+    if (!fFramed)
+    {
+      fSink->Write(output, size);
+      fBytesWritten += size;
+      return;
+    }
+    if (fBlockSize + kFloatRecordSize > fBlock.size())
+      FlushBlock();
+    std::memcpy(fBlock.data() + fBlockSize, output, size);
+    fBlockSize += size;
+    fBlockRecords++;
+    return;
+  }
+
+  if (fBlockSize + CompactRecordCodec::kMaxRecordSize > fBlock.size())
+    FlushBlock();
+
+  fBlockSize += fCodec->Encode(record, fBlock.data() + fBlockSize);
+  fBlockRecords++;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void PhaseSpaceWriter::EndOfEvent(G4int eventID)
+{
+  // files keep filling blocks across events, streams close the batch
+  if (!fFramed)
+    return;
+  FlushBlock();
+  std::int32_t id = eventID;
+  WriteFrame(kEndOfEventFrame, &id, sizeof(id));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void PhaseSpaceWriter::FlushBlock()
+{
+  if (fBlockRecords == 0)
+    return;
+
+  if (fFormat == Format::Float)
+  {
+    WriteFrame(kBatchFrame, fBlock.data(), (std::uint32_t)fBlockSize);
+    fBlockSize = 0;
+    fBlockRecords = 0;
+    return;
+  }
+
+  std::uint32_t header[3] = {fBlockRecords, (std::uint32_t)fBlockSize, (std::uint32_t)fBlockSize};
+  const std::uint8_t *payload = fBlock.data();
+
+#ifdef ALPHABEAM_WITH_ZLIB
+  if (fFormat == Format::CompactZlib)
+  {
+    uLongf storedSize = compressBound(fBlockSize);
+    fCompressed.resize(storedSize);
+    if (compress2(fCompressed.data(), &storedSize, fBlock.data(), fBlockSize,
+                  Z_DEFAULT_COMPRESSION) != Z_OK)
+    {
+      G4Exception("PhaseSpaceWriter::FlushBlock", "PhaseSpaceWriter003", JustWarning,
+                  "zlib compression failed, block stored uncompressed.");
+    }
+    else if (storedSize < fBlockSize)
+    {
+      // otherwise stored as is, readers check storedBytes == rawBytes
+      header[2] = (std::uint32_t)storedSize;
+      payload = fCompressed.data();
+    }
+  }
+#endif
+
+  if (fFramed)
+  {
+    std::uint32_t frame[2] = {kBatchFrame, (std::uint32_t)sizeof(header) + header[2]};
+    fSink->Write(frame, sizeof(frame));
+    fBytesWritten += sizeof(frame);
+  }
+  fSink->Write(header, sizeof(header));
+  fSink->Write(payload, header[2]);
+  fBytesWritten += sizeof(header) + header[2];
+
+  fBlockSize = 0;
+  fBlockRecords = 0;
+  fCodec->Reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void PhaseSpaceWriter::WriteFrame(FrameType type, const void *payload, std::uint32_t size)
+{
+  std::uint32_t frame[2] = {type, size};
+  fSink->Write(frame, sizeof(frame));
+  if (size > 0)
+    fSink->Write(payload, size);
+  fBytesWritten += sizeof(frame) + size;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void PhaseSpaceWriter::Close()
+{
+  if (!fSink)
+    return;
+
+  FlushBlock();
+  if (fFramed)
+    WriteFrame(kEndOfStreamFrame, nullptr, 0);
+  fSink->Close();
+
+  if (fNumRecords > 0)
+    G4cout << "\n----> Phase space: " << fNumRecords << " records, " << fBytesWritten
+           << " bytes (" << (G4double)fBytesWritten / fNumRecords << " bytes/record) to "
+           << fSink->GetName() << G4endl;
+  fSink.reset();
+}
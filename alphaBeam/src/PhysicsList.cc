@@ -91,7 +91,12 @@ PhysicsList::PhysicsList()
   RegisterPhysics(new G4RadioactiveDecayPhysics());
 
  G4ProductionCutsTable::GetProductionCutsTable()->SetEnergyRange(100 * eV, 1 * GeV);
-     RegisterPhysics(new G4StepLimiterPhysics());
+
+  // enforces the /det/limits/ user limits; applied to neutral particles too
+  // so that the minimum energy and maximum time also kill photons
+  G4StepLimiterPhysics* stepLimiter = new G4StepLimiterPhysics();
+  stepLimiter->SetApplyToAll(true);
+  RegisterPhysics(stepLimiter);
             
   // Hadron Elastic scattering
   // RegisterPhysics( new G4HadronElasticPhysicsHP(verb) );
@@ -30,12 +30,22 @@
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 #include "PrimaryGeneratorAction.hh"
+#include "PrimaryGeneratorMessenger.hh"
+#include "DetectorConstruction.hh"
+#include "EventSeed.hh"
+#include "CommandLineParser.hh"
 #include "G4Event.hh"
 #include "G4ParticleTable.hh"
 #include "G4IonTable.hh"
 #include "G4ParticleDefinition.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4RunManager.hh"
 #include "G4SystemOfUnits.hh"
 #include "Randomize.hh"
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <fstream>
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
@@ -49,12 +59,17 @@ PrimaryGeneratorAction::PrimaryGeneratorAction()
   fParticleGun->SetParticleEnergy(0*eV);
   fParticleGun->SetParticlePosition(G4ThreeVector(0.,0.,0.));
  
+  fMessenger = new PrimaryGeneratorMessenger(this);
+
+  if (G4DNAPARSER::Command *command = G4DNAPARSER::CommandLineParser::GetParser()->GetCommandIfActive("-replay"))
+    fReplayEvents = EventSeed::ParseEventList(command->GetOption());
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
 
 PrimaryGeneratorAction::~PrimaryGeneratorAction()
 {
+  delete fMessenger;
   delete fParticleGun;
 
 }
@@ -66,16 +81,304 @@ void PrimaryGeneratorAction::GeneratePrimaries(G4Event* anEvent)
 
   numParticles++;
 
+  // Replay: the k-th event of the run stands in for the k-th listed one,
+  // then the run is stopped.
+  G4int eventID = anEvent->GetEventID();
+  if (!fReplayEvents.empty())
+  {
+    if (fReplayIndex >= fReplayEvents.size())
+    {
+      anEvent->SetEventAborted();
+      G4RunManager::GetRunManager()->AbortRun(true);
+      return;
+    }
+    eventID = fReplayEvents[fReplayIndex++];
+    anEvent->SetEventID(eventID);
+    G4cout << "Replaying event " << eventID << G4endl;
+  }
+
+  // Everything drawn from here on, in the generator and in transport,
+  // follows from (master seed, eventID); leftover vertices drawn under an
+  // earlier event's seeds are dropped.
+  EventSeed::Apply(eventID);
+  fNextVertex = fVertices.size();
+  fNextBatch = 1;
+
   // G4double wirePosition = 0.5*mm; //only place Primary within central +/- 0.5mm because only calculating in central +/- 0.1 mm
   // G4double wireRadius = 0.15*mm;
-  // G4double zPos = (G4UniformRand() - 0.5) * wirePosition;
-  // G4double DummyAngle = G4UniformRand() * 2 * 3.1415926535;
   // G4double depth = 0*nm; //depth reported to be 5-20 nm deep, but recoil in Geant4 is only 1nm (geometric distance) so the Radon would never leave the source. Reported deabsoption percentages are around 40%. Placing the source is the largest possible deabsorption. However using post steop point get physical volume some will start outside the source.
-  // G4double xPos = (wireRadius-depth)*cos(DummyAngle);
-  // G4double yPos = (wireRadius-depth)*sin(DummyAngle);
+  // -> /source/type cylinder, /source/length 1 mm, /source/radius 0.15 mm, /source/depthProfile ...
+
+  if (!fLineEnergies.empty())
+    fParticleGun->SetParticleEnergy(SampleEnergy());
 
-  // fParticleGun->SetParticlePosition(G4ThreeVector(xPos,yPos,zPos));   
+  G4ThreeVector position = NextVertex();
+  if (fRestrictToLattice)
+  {
+    fParticleGun->SetParticleMomentumDirection(SampleTowardsLattice(position));
+  }
+  else if (fIsotropic)
+  {
+    G4double cosTheta = 1 - 2 * G4UniformRand();
+    G4double phi = twopi * G4UniformRand();
+    G4double sinTheta = std::sqrt(1 - cosTheta * cosTheta);
+    fParticleGun->SetParticleMomentumDirection(
+        G4ThreeVector(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta));
+    fNumTries++;
+    fSumHitSolidAngle += 1;
+  }
+  else
+  {
+    fNumTries++;
+    fSumHitSolidAngle += 1;
+  }
+
+  fParticleGun->SetParticlePosition(position);
   fParticleGun->GeneratePrimaryVertex(anEvent);
 
 }
-//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
\ No newline at end of file
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::SetSourceType(const G4String &type)
+{
+  if (type == "line")
+    fType = SourceType::Line;
+  else if (type == "cylinder")
+    fType = SourceType::Cylinder;
+  else if (type == "volume")
+    fType = SourceType::Volume;
+  else
+    fType = SourceType::Point;
+  fNextVertex = fVertices.size();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::SetDepthProfile(const G4String &profile)
+{
+  if (profile == "uniform")
+    fDepthProfile = DepthProfile::Uniform;
+  else if (profile == "exponential")
+    fDepthProfile = DepthProfile::Exponential;
+  else
+    fDepthProfile = DepthProfile::None;
+  fNextVertex = fVertices.size();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::LoadSpectrum(const G4String &fileName)
+{
+  std::ifstream file(fileName);
+  if (!file)
+  {
+    G4ExceptionDescription description;
+    description << "Cannot open spectrum file " << fileName << G4endl;
+    G4Exception("PrimaryGeneratorAction::LoadSpectrum", "Source001", FatalException, description);
+    return;
+  }
+
+  fLineEnergies.clear();
+  fLineCDF.clear();
+  G4double energy, weight, sum{0};
+  while (file >> energy >> weight)
+  {
+    if (weight <= 0)
+      continue;
+    sum += weight;
+    fLineEnergies.push_back(energy * MeV);
+    fLineCDF.push_back(sum);
+  }
+  for (auto &c : fLineCDF)
+    c /= sum;
+
+  G4cout << "Source spectrum: " << fLineEnergies.size() << " lines from " << fileName << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PrimaryGeneratorAction::SampleEnergy() const
+{
+  auto it = std::lower_bound(fLineCDF.begin(), fLineCDF.end(), G4UniformRand());
+  if (it == fLineCDF.end())
+    --it;
+  return fLineEnergies[it - fLineCDF.begin()];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector PrimaryGeneratorAction::NextVertex()
+{
+  if (fType == SourceType::Point)
+    return fCentre;
+  if (fNextVertex >= fVertices.size())
+    FillVertexBatch();
+  return fVertices[fNextVertex++];
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::FillVertexBatch()
+{
+  // One engine call for the whole batch, then branch-free loops per shape.
+  // Batches do not outlive an event (see GeneratePrimaries), so each event
+  // starts with a single vertex and doubles the batch on every refill, up
+  // to /source/batchSize: at most twice the vertices used are drawn.
+  std::size_t n = fNextBatch;
+  fNextBatch = std::min(2 * n, (std::size_t)fBatchSize);
+  fRandom.resize(3 * n);
+  fVertices.resize(n);
+  G4Random::getTheEngine()->flatArray(3 * n, fRandom.data());
+  const G4double *u = fRandom.data();
+
+  if (fType == SourceType::Line)
+  {
+    for (std::size_t i = 0; i < n; i++)
+      fVertices[i].set(0, 0, (u[i] - 0.5) * fLength);
+  }
+  else if (fType == SourceType::Volume)
+  {
+    for (std::size_t i = 0; i < n; i++)
+    {
+      G4double r = fRadius * std::sqrt(u[i]);
+      G4double phi = twopi * u[n + i];
+      fVertices[i].set(r * std::cos(phi), r * std::sin(phi), (u[2 * n + i] - 0.5) * fLength);
+    }
+  }
+  else
+  {
+    std::vector<G4double> depth(n, 0.);
+    if (fDepthProfile == DepthProfile::Uniform)
+    {
+      for (std::size_t i = 0; i < n; i++)
+        depth[i] = fDepth * u[i];
+    }
+    else if (fDepthProfile == DepthProfile::Exponential)
+    {
+      for (std::size_t i = 0; i < n; i++)
+        depth[i] = std::min(-fDepth * std::log(1 - u[i]), fRadius);
+    }
+    for (std::size_t i = 0; i < n; i++)
+    {
+      G4double r = fRadius - depth[i];
+      G4double phi = twopi * u[n + i];
+      fVertices[i].set(r * std::cos(phi), r * std::sin(phi), (u[2 * n + i] - 0.5) * fLength);
+    }
+  }
+
+  for (auto &vertex : fVertices)
+    vertex += fCentre;
+  fNextVertex = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4ThreeVector PrimaryGeneratorAction::SampleTowardsLattice(G4ThreeVector &vertex)
+{
+  auto detector = (const DetectorConstruction *)G4RunManager::GetRunManager()->GetUserDetectorConstruction();
+  const VoxelLattice &lattice = detector->get_lattice();
+  const G4ThreeVector &boxMin = lattice.GetMin();
+  const G4ThreeVector &boxMax = lattice.GetMax();
+  G4ThreeVector boxCentre = 0.5 * (boxMin + boxMax);
+  G4double boxRadius = 0.5 * (boxMax - boxMin).mag();
+
+  // Upper bound on the cone fraction 0.5*(1-cosAlpha) over all source
+  // vertices: the cone enclosing the box lies inside the one enclosing its
+  // bounding sphere, seen from the source point closest to the box centre.
+  G4double maxFraction = 1;
+  if (fType != SourceType::Point)
+  {
+    G4ThreeVector offset = boxCentre - fCentre;
+    G4double sourceRadius = fType == SourceType::Line ? 0. : fRadius;
+    G4double dr = std::max(0., offset.perp() - sourceRadius);
+    G4double dz = std::max(0., std::fabs(offset.z()) - 0.5 * fLength);
+    G4double distance = std::sqrt(dr * dr + dz * dz);
+    if (distance > boxRadius)
+    {
+      G4double sinMax = boxRadius / distance;
+      maxFraction = 0.5 * (1 - std::sqrt(1 - sinMax * sinMax));
+    }
+  }
+
+  // Each try takes a new vertex, kept with probability cone/maxFraction before
+  // a direction is drawn in its cone and kept if it hits the box. A kept
+  // primary then has density p(v) * solidAngleHit(v), as for 4pi emission cut
+  // to the rays that reach the lattice; without the vertex step it would be
+  // p(v) * solidAngleHit(v) / cone(v). Each hit stands for maxFraction of 4pi.
+  while (true)
+  {
+    fNumTries++;
+
+    G4bool inside = lattice.IsInBoundingBox(vertex);
+
+    // cone from the vertex enclosing the lattice bounding box
+    G4ThreeVector axis = (boxCentre - vertex).unit();
+    G4double cosAlpha = -1;
+    if (!inside)
+    {
+      cosAlpha = 1;
+      for (G4int corner = 0; corner < 8; corner++)
+      {
+        G4ThreeVector c((corner & 1) ? boxMax.x() : boxMin.x(),
+                        (corner & 2) ? boxMax.y() : boxMin.y(),
+                        (corner & 4) ? boxMax.z() : boxMin.z());
+        cosAlpha = std::min(cosAlpha, axis.dot((c - vertex).unit()));
+      }
+    }
+    G4double fraction = 0.5 * (1 - cosAlpha);
+    if (fType == SourceType::Point)
+      maxFraction = fraction;
+    else if (G4UniformRand() * maxFraction > fraction)
+    {
+      vertex = NextVertex();
+      continue;
+    }
+
+    G4double cosTheta = 1 - G4UniformRand() * (1 - cosAlpha);
+    G4double sinTheta = std::sqrt(std::max(0., 1 - cosTheta * cosTheta));
+    G4double phi = twopi * G4UniformRand();
+    G4ThreeVector direction(sinTheta * std::cos(phi), sinTheta * std::sin(phi), cosTheta);
+    direction.rotateUz(axis);
+
+    // slab test of the ray against the bounding box
+    G4double tNear = 0, tFar = DBL_MAX;
+    for (G4int axisIndex = 0; axisIndex < 3 && tNear <= tFar; axisIndex++)
+    {
+      G4double d = direction[axisIndex];
+      if (std::fabs(d) < 1e-300)
+      {
+        if (vertex[axisIndex] < boxMin[axisIndex] || vertex[axisIndex] > boxMax[axisIndex])
+          tFar = -1;
+        continue;
+      }
+      G4double t1 = (boxMin[axisIndex] - vertex[axisIndex]) / d;
+      G4double t2 = (boxMax[axisIndex] - vertex[axisIndex]) / d;
+      tNear = std::max(tNear, std::min(t1, t2));
+      tFar = std::min(tFar, std::max(t1, t2));
+    }
+    if (tNear <= tFar)
+    {
+      fSumHitSolidAngle += maxFraction;
+      return direction;
+    }
+    vertex = NextVertex();
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorAction::ResetCounters()
+{
+  fNumTries = 0;
+  fSumHitSolidAngle = 0;
+  fReplayIndex = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+G4double PrimaryGeneratorAction::GetGeometricEfficiency() const
+{
+  return fNumTries > 0 ? fSumHitSolidAngle / fNumTries : 1.;
+}
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,157 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file PrimaryGeneratorMessenger.cc
+/// \brief Implementation of the PrimaryGeneratorMessenger class
+
+#include "PrimaryGeneratorMessenger.hh"
+
+#include "PrimaryGeneratorAction.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWith3VectorAndUnit.hh"
+#include "G4UIcmdWithAnInteger.hh"
+#include "G4UIcmdWithABool.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PrimaryGeneratorMessenger::PrimaryGeneratorMessenger(PrimaryGeneratorAction *gen)
+    : G4UImessenger(), fGenerator(gen)
+{
+  fSourceDir = new G4UIdirectory("/source/");
+  fSourceDir->SetGuidance("Distributed radioactive source; particle, ion and energy via /gun/");
+
+  fTypeCmd = new G4UIcmdWithAString("/source/type",this);
+  fTypeCmd->SetGuidance("Source shape: point, line (along z), cylinder (surface) or volume");
+  fTypeCmd->SetParameterName("type",false);
+  fTypeCmd->SetCandidates("point line cylinder volume");
+  fTypeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fCentreCmd = new G4UIcmdWith3VectorAndUnit("/source/centre",this);
+  fCentreCmd->SetGuidance("Centre of the source");
+  fCentreCmd->SetParameterName("x","y","z",false);
+  fCentreCmd->SetDefaultUnit("mm");
+  fCentreCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fLengthCmd = new G4UIcmdWithADoubleAndUnit("/source/length",this);
+  fLengthCmd->SetGuidance("Length along z of line, cylinder and volume sources");
+  fLengthCmd->SetParameterName("length",false);
+  fLengthCmd->SetRange("length>=0.");
+  fLengthCmd->SetDefaultUnit("mm");
+  fLengthCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fRadiusCmd = new G4UIcmdWithADoubleAndUnit("/source/radius",this);
+  fRadiusCmd->SetGuidance("Radius of cylinder and volume sources");
+  fRadiusCmd->SetParameterName("radius",false);
+  fRadiusCmd->SetRange("radius>=0.");
+  fRadiusCmd->SetDefaultUnit("mm");
+  fRadiusCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fDepthProfileCmd = new G4UIcmdWithAString("/source/depthProfile",this);
+  fDepthProfileCmd->SetGuidance("Depth of cylinder-surface vertices below the surface:");
+  fDepthProfileCmd->SetGuidance("none, uniform in [0,depth] or exponential with mean depth");
+  fDepthProfileCmd->SetParameterName("profile",false);
+  fDepthProfileCmd->SetCandidates("none uniform exponential");
+  fDepthProfileCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fDepthCmd = new G4UIcmdWithADoubleAndUnit("/source/depth",this);
+  fDepthCmd->SetGuidance("Maximum (uniform) or mean (exponential) depth");
+  fDepthCmd->SetParameterName("depth",false);
+  fDepthCmd->SetRange("depth>=0.");
+  fDepthCmd->SetDefaultUnit("nm");
+  fDepthCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fSpectrumCmd = new G4UIcmdWithAString("/source/spectrumFile",this);
+  fSpectrumCmd->SetGuidance("Energy lines, one 'energy[MeV] weight' pair per line;");
+  fSpectrumCmd->SetGuidance("overrides /gun/energy");
+  fSpectrumCmd->SetParameterName("file",false);
+  fSpectrumCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fIsotropicCmd = new G4UIcmdWithABool("/source/isotropic",this);
+  fIsotropicCmd->SetGuidance("Emit isotropically instead of along /gun/direction");
+  fIsotropicCmd->SetParameterName("isotropic",true);
+  fIsotropicCmd->SetDefaultValue(true);
+  fIsotropicCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fRestrictCmd = new G4UIcmdWithABool("/source/restrictToLattice",this);
+  fRestrictCmd->SetGuidance("Emit isotropically but only towards the voxel lattice;");
+  fRestrictCmd->SetGuidance("the geometric efficiency is reported for normalisation");
+  fRestrictCmd->SetParameterName("restrict",true);
+  fRestrictCmd->SetDefaultValue(true);
+  fRestrictCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+
+  fBatchCmd = new G4UIcmdWithAnInteger("/source/batchSize",this);
+  fBatchCmd->SetGuidance("Number of vertices sampled per batch");
+  fBatchCmd->SetParameterName("batchSize",false);
+  fBatchCmd->SetRange("batchSize>0");
+  fBatchCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+PrimaryGeneratorMessenger::~PrimaryGeneratorMessenger()
+{
+  delete fTypeCmd;
+  delete fCentreCmd;
+  delete fLengthCmd;
+  delete fRadiusCmd;
+  delete fDepthProfileCmd;
+  delete fDepthCmd;
+  delete fSpectrumCmd;
+  delete fIsotropicCmd;
+  delete fRestrictCmd;
+  delete fBatchCmd;
+  delete fSourceDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void PrimaryGeneratorMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
+{
+  if (command == fTypeCmd)
+    fGenerator->SetSourceType(newValue);
+  if (command == fCentreCmd)
+    fGenerator->SetCentre(fCentreCmd->GetNew3VectorValue(newValue));
+  if (command == fLengthCmd)
+    fGenerator->SetLength(fLengthCmd->GetNewDoubleValue(newValue));
+  if (command == fRadiusCmd)
+    fGenerator->SetRadius(fRadiusCmd->GetNewDoubleValue(newValue));
+  if (command == fDepthProfileCmd)
+    fGenerator->SetDepthProfile(newValue);
+  if (command == fDepthCmd)
+    fGenerator->SetDepth(fDepthCmd->GetNewDoubleValue(newValue));
+  if (command == fSpectrumCmd)
+    fGenerator->LoadSpectrum(newValue);
+  if (command == fIsotropicCmd)
+    fGenerator->SetIsotropic(fIsotropicCmd->GetNewBoolValue(newValue));
+  if (command == fRestrictCmd)
+    fGenerator->SetRestrictToLattice(fRestrictCmd->GetNewBoolValue(newValue));
+  if (command == fBatchCmd)
+    fGenerator->SetBatchSize(fBatchCmd->GetNewIntValue(newValue));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
@@ -0,0 +1,182 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RNTupleTrackingWriter.cc
+/// \brief Implementation of the RNTupleTrackingWriter class
+
+#include "RNTupleTrackingWriter.hh"
+
+#ifdef ALPHABEAM_WITH_RNTUPLE
+
+#include "InfoTree.hh"
+#include "VoxelEntryRecord.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include "RVersion.h"
+#include "TFile.h"
+#include <ROOT/RNTupleModel.hxx>
+#include <ROOT/RNTupleWriter.hxx>
+#include <memory>
+
+// RNTuple left ROOT::Experimental in ROOT 6.36
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6, 35, 0)
+namespace RNT = ROOT;
+#else
+namespace RNT = ROOT::Experimental;
+#endif
+
+namespace
+{
+// target size of a compressed cluster
+const std::size_t kClusterSize = 64 * 1024 * 1024;
+}
+
+struct RNTupleTrackingWriter::Columns
+{
+    std::unique_ptr<RNT::RNTupleWriter> writer;
+    std::shared_ptr<std::int32_t> eventID;
+    std::shared_ptr<float> energy;
+    std::shared_ptr<float> eDep;
+    std::shared_ptr<std::uint8_t> particleID;
+    std::shared_ptr<std::int32_t> copyNo;
+    std::shared_ptr<float> posX;
+    std::shared_ptr<float> posY;
+    std::shared_ptr<float> posZ;
+    std::shared_ptr<float> stepLength;
+    std::shared_ptr<std::int32_t> trackID;
+    std::shared_ptr<std::int32_t> parentID;
+    std::shared_ptr<std::int32_t> entry;
+    std::shared_ptr<std::int32_t> pdg;
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+RNTupleTrackingWriter::RNTupleTrackingWriter(G4int compression)
+    : fCompression(compression)
+{
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+RNTupleTrackingWriter::~RNTupleTrackingWriter()
+{
+  delete fColumns;
+  delete fFile;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool RNTupleTrackingWriter::Open(const G4String &fileName)
+{
+  fFileName = fileName;
+  if (!G4StrUtil::ends_with(fFileName, ".root"))
+    fFileName += ".root";
+  if (!G4Threading::IsMasterThread())
+    fFileName.insert(fFileName.size() - 5, "_t" + std::to_string(G4Threading::G4GetThreadId()));
+
+  fFile = TFile::Open(fFileName.c_str(), "RECREATE", "alphaBeam", fCompression);
+  if (fFile == nullptr || fFile->IsZombie())
+  {
+    G4cout << "\n---> RNTupleTrackingWriter::Open(): cannot open " << fFileName << G4endl;
+    delete fFile;
+    fFile = nullptr;
+    return false;
+  }
+  G4cout << "\n----> RNTuple file is opened in " << fFileName
+         << " (compression " << fCompression << ")" << G4endl;
+
+  fColumns = new Columns;
+  auto model = RNT::RNTupleModel::Create();
+  fColumns->eventID = model->MakeField<std::int32_t>("EventID");
+  fColumns->energy = model->MakeField<float>("particleEnergy_MeV");
+  fColumns->eDep = model->MakeField<float>("eDep_MeV");
+  fColumns->particleID = model->MakeField<std::uint8_t>("particleID");
+  fColumns->copyNo = model->MakeField<std::int32_t>("copyNo");
+  fColumns->posX = model->MakeField<float>("posX");
+  fColumns->posY = model->MakeField<float>("posY");
+  fColumns->posZ = model->MakeField<float>("posZ");
+  fColumns->stepLength = model->MakeField<float>("stepLength");
+  fColumns->trackID = model->MakeField<std::int32_t>("trackID");
+  fColumns->parentID = model->MakeField<std::int32_t>("parentID");
+  fColumns->entry = model->MakeField<std::int32_t>("entry");
+  fColumns->pdg = model->MakeField<std::int32_t>("pdg");
+
+  RNT::RNTupleWriteOptions options;
+  options.SetCompression(fCompression);
+  options.SetApproxZippedClusterSize(kClusterSize);
+  fColumns->writer = RNT::RNTupleWriter::Append(std::move(model), "TrackingData", *fFile, options);
+
+  fNumRecords = 0;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RNTupleTrackingWriter::Fill(const VoxelEntryRecord &record)
+{
+  if (fColumns == nullptr)
+    return;
+  StartTimer();
+  *fColumns->eventID = record.eventID;
+  *fColumns->energy = record.kineticEnergy / MeV;
+  *fColumns->eDep = record.energyDeposit / MeV;
+  *fColumns->particleID = (std::uint8_t)record.particleID;
+  *fColumns->copyNo = record.copyNo;
+  *fColumns->posX = record.worldPosition.x() / nanometer;
+  *fColumns->posY = record.worldPosition.y() / nanometer;
+  *fColumns->posZ = record.worldPosition.z() / nanometer;
+  *fColumns->stepLength = record.stepLength;
+  *fColumns->trackID = record.trackID;
+  *fColumns->parentID = record.parentID;
+  *fColumns->entry = record.entry;
+  *fColumns->pdg = record.pdg;
+  fColumns->writer->Fill();
+  fNumRecords++;
+  StopTimer();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RNTupleTrackingWriter::Close(const RunInfo &info)
+{
+  if (fFile == nullptr)
+    return;
+  StartTimer();
+
+  // destroying the writer commits the last cluster and the RNTuple anchor
+  delete fColumns;
+  fColumns = nullptr;
+
+  WriteInfoTree(fFile, info);
+
+  fFile->Close();
+  delete fFile;
+  fFile = nullptr;
+  StopTimer();
+  PrintThroughput("rntuple", fFileName);
+}
+
+#endif
@@ -0,0 +1,267 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+//
+/// \file RecordAndKill.cc
+/// \brief Implementation of the RecordAndKill class
+
+#include "RecordAndKill.hh"
+#include "RecordAndKillMessenger.hh"
+#include "VoxelEntryRecord.hh"
+#include "G4Step.hh"
+#include "G4Track.hh"
+#include "G4EmCalculator.hh"
+#include "G4NistManager.hh"
+#include "G4ParticleTable.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include <cfloat>
+#include <cmath>
+#include <sstream>
+
+namespace
+{
+// the particles with a range table; ions and the others are never stopped
+G4int ParticleID(const G4String &name)
+{
+  G4int id = ParticleSpecies::FindID(name);
+  return id <= ParticleSpecies::kProton ? id : 0;
+}
+
+// the highest energy whose range (from the restricted dE/dx, so a little
+// longer than the CSDA range) is below maxRange, 0 if none
+G4double EnergyOfRange(const G4String &particleName, const G4Material *material, G4double maxRange)
+{
+  const G4ParticleDefinition *particle = G4ParticleTable::GetParticleTable()->FindParticle(particleName);
+  G4EmCalculator calculator;
+  G4double low = 10 * eV;
+  G4double high = 1 * GeV;
+  if (calculator.GetRangeFromRestricteDEDX(low, particle, material) >= maxRange)
+    return 0;
+  for (G4int i = 0; i < 60; i++)
+  {
+    G4double energy = std::sqrt(low * high);
+    if (calculator.GetRangeFromRestricteDEDX(energy, particle, material) < maxRange)
+      low = energy;
+    else
+      high = energy;
+  }
+  return low;
+}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+RecordAndKill *RecordAndKill::Instance()
+{
+  static RecordAndKill instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+RecordAndKill::RecordAndKill()
+{
+  fMessenger = new RecordAndKillMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+RecordAndKill::~RecordAndKill()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordAndKill::SetParticles(const G4String &names)
+{
+  fParticleMask = 0;
+  std::istringstream is(names);
+  G4String name;
+  while (is >> name)
+  {
+    if (name == "none")
+      continue;
+    G4int id = ParticleID(name);
+    if (id == 0)
+    {
+      G4ExceptionDescription msg;
+      msg << "cannot stop '" << name << "', expected e-, gamma, alpha, proton or none";
+      G4Exception("RecordAndKill::SetParticles", "Kill001", FatalException, msg);
+      return;
+    }
+    fParticleMask |= 1 << id;
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordAndKill::SetMaxEnergy(const G4String &particle, G4double energy)
+{
+  if (G4int id = ParticleID(particle))
+    fMaxEnergy[id] = energy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::unique_ptr<RecordAndKill::Policy> RecordAndKill::Compile(G4double voxelPitch) const
+{
+  if (!IsEnabled())
+    return nullptr;
+
+  // the voxels are water
+  const G4Material *material = G4NistManager::Instance()->FindOrBuildMaterial("G4_WATER");
+  G4double maxRange = fMaxRange > 0 ? fMaxRange : voxelPitch;
+
+  auto policy = std::make_unique<Policy>();
+  policy->fDryRun = fDryRun;
+  for (G4int id = 1; id < Policy::kNumParticles; id++)
+  {
+    if (!(fParticleMask & (1 << id)))
+      continue;
+    if (fMaxEnergy[id] > 0)
+      policy->fMaxEnergy[id] = fMaxEnergy[id];
+    else if (id == 2)
+      G4Exception("RecordAndKill::Compile", "Kill002", JustWarning,
+                  "gammas have no range, set /kill/maxEnergy gamma to stop them");
+    else
+      policy->fMaxEnergy[id] = EnergyOfRange(ParticleSpecies::GetName(id), material, maxRange);
+  }
+  return policy;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool RecordAndKill::Policy::Kill(const VoxelEntryRecord &record, const G4Step *step, G4bool withSecondaries)
+{
+  // a dry-run track already past its stopping point is not counted again
+  if (fShadowed || record.kineticEnergy >= fMaxEnergy[record.particleID])
+    return false;
+  fKilled[record.particleID]++;
+  fKilledEnergy[record.particleID] += record.kineticEnergy;
+  if (!fDryRun)
+    return true;
+
+  // from here on, all this track and its descendants do is what stopping
+  // saves; those of an entering particle's step stay in the water
+  fShadowed = true;
+  fShadowTracks[fTrackID] = withSecondaries ? -DBL_MAX : step->GetPostStepPoint()->GetGlobalTime();
+  return false;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordAndKill::Policy::Shadow(const G4Step *step)
+{
+  // the time since the previous step is that of this one; not counted for
+  // the first step of an event
+  auto now = std::chrono::steady_clock::now();
+  const G4Track *track = step->GetTrack();
+  if (track->GetTrackID() != fTrackID) // a new track, or a suspended one resumed
+  {
+    fTrackID = track->GetTrackID();
+    fShadowed = fShadowTracks.count(fTrackID) > 0;
+    if (!fShadowed && track->GetCurrentStepNumber() == 1)
+    {
+      // a secondary of a shadowed track, created after its stopping point
+      auto parent = fShadowTracks.find(track->GetParentID());
+      if (parent != fShadowTracks.end() && step->GetPreStepPoint()->GetGlobalTime() > parent->second)
+      {
+        fShadowed = true;
+        fShadowTracks.emplace(fTrackID, -DBL_MAX);
+      }
+    }
+  }
+  if (fLastStep != std::chrono::steady_clock::time_point())
+  {
+    G4double seconds = std::chrono::duration<G4double>(now - fLastStep).count();
+    fStepSeconds += seconds;
+    if (fShadowed)
+      fShadowSeconds += seconds;
+  }
+  fLastStep = now;
+
+  fSteps++;
+  if (fShadowed)
+    fShadowSteps++;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordAndKill::Policy::EndOfEvent()
+{
+  fShadowed = false;
+  fTrackID = 0;
+  fShadowTracks.clear();
+  fLastStep = std::chrono::steady_clock::time_point();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordAndKill::Policy::Merge(const Policy &other)
+{
+  for (G4int id = 0; id < kNumParticles; id++)
+  {
+    fKilled[id] += other.fKilled[id];
+    fKilledEnergy[id] += other.fKilledEnergy[id];
+  }
+  fStepSeconds += other.fStepSeconds;
+  fShadowSeconds += other.fShadowSeconds;
+  fSteps += other.fSteps;
+  fShadowSteps += other.fShadowSteps;
+  fShadowRecords += other.fShadowRecords;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordAndKill::Policy::Print() const
+{
+  G4cout << (fDryRun ? "Record and kill, dry run (nothing stopped):" : "Record and kill:") << G4endl;
+  for (G4int id = 1; id < kNumParticles; id++)
+  {
+    if (fMaxEnergy[id] <= 0)
+      continue;
+    G4cout << "  " << ParticleSpecies::GetName(id) << " below " << G4BestUnit(fMaxEnergy[id], "Energy") << ": "
+           << fKilled[id] << (fDryRun ? " would be" : "") << " stopped at their record";
+    if (fKilled[id] > 0)
+      G4cout << ", " << G4BestUnit(fKilledEnergy[id], "Energy") << " not transported further";
+    G4cout << G4endl;
+  }
+  if (!fDryRun)
+  {
+    G4cout << "  the CPU time saved and records removed are measured with /kill/dryRun" << G4endl;
+    return;
+  }
+  if (fSteps == 0)
+    return;
+  G4cout << "  after their stopping points these tracks and their descendants took " << fShadowSteps
+         << " of " << fSteps << " steps (" << 100. * fShadowSteps / fSteps << " %), "
+         << G4BestUnit(fShadowSeconds * s, "Time") << " of " << G4BestUnit(fStepSeconds * s, "Time")
+         << " stepping time (" << (fStepSeconds > 0 ? 100. * fShadowSeconds / fStepSeconds : 0.)
+         << " %)," << G4endl
+         << "  and wrote " << fShadowRecords << " records that stopping would remove" << G4endl;
+}
@@ -0,0 +1,118 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RecordAndKillMessenger.cc
+/// \brief Implementation of the RecordAndKillMessenger class
+
+#include "RecordAndKillMessenger.hh"
+
+#include "RecordAndKill.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcommand.hh"
+#include "G4UIparameter.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithADoubleAndUnit.hh"
+#include "G4UIcmdWithABool.hh"
+#include <sstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RecordAndKillMessenger::RecordAndKillMessenger(RecordAndKill *kill)
+    : G4UImessenger(), fKill(kill)
+{
+  fKillDir = new G4UIdirectory("/kill/");
+  fKillDir->SetGuidance("Stop particles once they are recorded at a voxel");
+
+  fParticlesCmd = new G4UIcmdWithAString("/kill/particles",this);
+  fParticlesCmd->SetGuidance("Particles to stop after recording: e- gamma alpha proton, or none");
+  fParticlesCmd->SetParameterName("particles",false);
+  fParticlesCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fParticlesCmd->SetToBeBroadcasted(false);
+
+  fMaxRangeCmd = new G4UIcmdWithADoubleAndUnit("/kill/maxRange",this);
+  fMaxRangeCmd->SetGuidance("Stop only particles whose residual range in the voxel material is below this;");
+  fMaxRangeCmd->SetGuidance("0 for the voxel pitch");
+  fMaxRangeCmd->SetParameterName("range",false);
+  fMaxRangeCmd->SetRange("range>=0.");
+  fMaxRangeCmd->SetUnitCategory("Length");
+  fMaxRangeCmd->SetDefaultUnit("nm");
+  fMaxRangeCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fMaxRangeCmd->SetToBeBroadcasted(false);
+
+  fMaxEnergyCmd = new G4UIcommand("/kill/maxEnergy",this);
+  fMaxEnergyCmd->SetGuidance("Stop the particle below this kinetic energy instead of using the range limit;");
+  fMaxEnergyCmd->SetGuidance("0 to go back to the range limit");
+  G4UIparameter *particle = new G4UIparameter("particle", 's', false);
+  particle->SetParameterCandidates("e- gamma alpha proton");
+  fMaxEnergyCmd->SetParameter(particle);
+  G4UIparameter *value = new G4UIparameter("value", 'd', false);
+  value->SetParameterRange("value>=0.");
+  fMaxEnergyCmd->SetParameter(value);
+  G4UIparameter *unit = new G4UIparameter("unit", 's', true);
+  unit->SetDefaultValue("keV");
+  unit->SetParameterCandidates(G4UIcommand::UnitsList("Energy"));
+  fMaxEnergyCmd->SetParameter(unit);
+  fMaxEnergyCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fMaxEnergyCmd->SetToBeBroadcasted(false);
+
+  fDryRunCmd = new G4UIcmdWithABool("/kill/dryRun",this);
+  fDryRunCmd->SetGuidance("Stop nothing, report the CPU time and records stopping would remove");
+  fDryRunCmd->SetParameterName("dryRun",true);
+  fDryRunCmd->SetDefaultValue(true);
+  fDryRunCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fDryRunCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RecordAndKillMessenger::~RecordAndKillMessenger()
+{
+  delete fParticlesCmd;
+  delete fMaxRangeCmd;
+  delete fMaxEnergyCmd;
+  delete fDryRunCmd;
+  delete fKillDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RecordAndKillMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
+{
+  if (command == fParticlesCmd)
+    fKill->SetParticles(newValue);
+  if (command == fMaxRangeCmd)
+    fKill->SetMaxRange(fMaxRangeCmd->GetNewDoubleValue(newValue));
+  if (command == fMaxEnergyCmd)
+  {
+    std::istringstream is(newValue);
+    G4String particle, unit;
+    G4double value;
+    is >> particle >> value >> unit;
+    fKill->SetMaxEnergy(particle, value * G4UIcommand::ValueOf(unit));
+  }
+  if (command == fDryRunCmd)
+    fKill->SetDryRun(fDryRunCmd->GetNewBoolValue(newValue));
+}
@@ -0,0 +1,195 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RecordConsumerSet.cc
+/// \brief Implementation of the RecordConsumerSet class
+
+#include "RecordConsumerSet.hh"
+#include <dlfcn.h>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+namespace
+{
+struct ConsumerLibrary
+{
+    G4String path;
+    G4String args;
+    RecordConsumerCreateFunction create;
+    RecordConsumerDestroyFunction destroy;
+};
+
+// filled before the first run and never changed afterwards, so worker
+// threads read it without locking; the libraries stay loaded until exit
+std::vector<ConsumerLibrary> libraries;
+
+void *LookUp(void *handle, const G4String &path, const char *symbol)
+{
+    void *address = dlsym(handle, symbol);
+    if (address == nullptr)
+    {
+        G4ExceptionDescription description;
+        description << path << " does not export " << symbol
+                    << ", was it built with ALPHABEAM_RECORD_CONSUMER?";
+        G4Exception("RecordConsumerSet::LoadLibraries", "Consumer002", FatalException, description);
+    }
+    return address;
+}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordConsumerSet::LoadLibraries(const G4String &spec)
+{
+    std::size_t start = 0;
+    while (start < spec.size())
+    {
+        std::size_t comma = spec.find(',', start);
+        if (comma == std::string::npos)
+            comma = spec.size();
+        G4String item = spec.substr(start, comma - start);
+        start = comma + 1;
+        if (item.empty())
+            continue;
+
+        ConsumerLibrary library;
+        std::size_t colon = item.find(':');
+        library.path = item.substr(0, colon);
+        if (colon != std::string::npos)
+            library.args = item.substr(colon + 1);
+
+        void *handle = dlopen(library.path.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (handle == nullptr)
+        {
+            G4ExceptionDescription description;
+            description << "cannot load consumer " << library.path << ": " << dlerror();
+            G4Exception("RecordConsumerSet::LoadLibraries", "Consumer001", FatalException, description);
+            continue;
+        }
+
+        auto version = (RecordConsumerVersionFunction)LookUp(handle, library.path, "alphaBeamConsumerApiVersion");
+        if (version() != ALPHABEAM_CONSUMER_API_VERSION)
+        {
+            G4ExceptionDescription description;
+            description << library.path << " was built for consumer API version " << version()
+                        << ", this alphaBeam has version " << ALPHABEAM_CONSUMER_API_VERSION;
+            G4Exception("RecordConsumerSet::LoadLibraries", "Consumer003", FatalException, description);
+        }
+        library.create = (RecordConsumerCreateFunction)LookUp(handle, library.path, "alphaBeamCreateConsumer");
+        library.destroy = (RecordConsumerDestroyFunction)LookUp(handle, library.path, "alphaBeamDestroyConsumer");
+
+        G4cout << "Loaded record consumer " << library.path
+               << (library.args.empty() ? "" : " (" + library.args + ")") << G4endl;
+        libraries.push_back(library);
+    }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool RecordConsumerSet::HasLibraries()
+{
+    return !libraries.empty();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+RecordConsumerSet::RecordConsumerSet(EventArena &arena)
+    : fArena(arena)
+{
+    for (const auto &library : libraries)
+        fConsumers.push_back(library.create(library.args.c_str()));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+RecordConsumerSet::~RecordConsumerSet()
+{
+    // deleted by the library that allocated them
+    for (std::size_t i = 0; i < fConsumers.size(); i++)
+        libraries[i].destroy(fConsumers[i]);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordConsumerSet::BeginOfRun(const ConsumerRunInfo &info)
+{
+    fBlocks.clear();
+    fBlock = nullptr;
+    fBlockSize = 0;
+    for (auto consumer : fConsumers)
+        consumer->BeginOfRun(info);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordConsumerSet::NewBlock()
+{
+    if (fBlock != nullptr)
+        fBlocks.push_back(RecordSpan{fBlock, fBlockSize});
+    fBlock = (VoxelEntryRecord *)fArena.Allocate(kBlockCapacity*sizeof(VoxelEntryRecord), alignof(VoxelEntryRecord));
+    fBlockSize = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordConsumerSet::Flush()
+{
+    if (fBlock != nullptr && fBlockSize > 0)
+        fBlocks.push_back(RecordSpan{fBlock, fBlockSize});
+    fBlock = nullptr;
+    fBlockSize = 0;
+
+    for (const auto &span : fBlocks)
+        for (auto consumer : fConsumers)
+            consumer->ProcessRecords(span);
+    fBlocks.clear(); // keeps its capacity
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordConsumerSet::EndOfEvent(G4int eventID)
+{
+    Flush();
+    for (auto consumer : fConsumers)
+        consumer->EndOfEvent(eventID);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordConsumerSet::EndOfRun(G4int numEvents)
+{
+    Flush();
+    for (auto consumer : fConsumers)
+        consumer->EndOfRun(numEvents);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordConsumerSet::Merge(RecordConsumerSet &worker)
+{
+    for (std::size_t i = 0; i < fConsumers.size(); i++)
+        fConsumers[i]->Merge(*worker.fConsumers[i]);
+}
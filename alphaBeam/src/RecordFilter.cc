@@ -0,0 +1,289 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RecordFilter.cc
+/// \brief Implementation of the RecordFilter class
+
+#include "RecordFilter.hh"
+#include "RecordFilterMessenger.hh"
+#include "ParticleSpecies.hh"
+#include "G4ProcessTable.hh"
+#include "G4ProcessVector.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4UnitsTable.hh"
+#include <cstdlib>
+#include <sstream>
+
+namespace
+{
+void RuleError(const G4String &spec, const G4String &reason)
+{
+  G4ExceptionDescription msg;
+  msg << reason << " in filter rule '" << spec << "'";
+  G4Exception("RecordFilter::AddRule", "RecordFilter001", FatalException, msg);
+}
+
+std::vector<G4String> Split(const G4String &text, char separator)
+{
+  std::vector<G4String> items;
+  std::istringstream is(text);
+  std::string item;
+  while (std::getline(is, item, separator))
+    items.push_back(item);
+  if (!text.empty() && text.back() == separator)
+    items.push_back("");
+  return items;
+}
+
+// a number spanning the whole of text
+G4bool ParseNumber(const G4String &text, G4double &value)
+{
+  char *end;
+  value = std::strtod(text.c_str(), &end);
+  return !text.empty() && *end == '\0';
+}
+
+G4bool ParseInt(const G4String &text, G4int &value)
+{
+  char *end;
+  value = (G4int)std::strtol(text.c_str(), &end, 10);
+  return !text.empty() && *end == '\0';
+}
+
+// "10eV" or "0.5" (MeV); false unless the unit is an energy
+G4bool ParseEnergy(const G4String &text, G4double &energy)
+{
+  char *end;
+  G4double value = std::strtod(text.c_str(), &end);
+  if (end == text.c_str())
+    return false;
+  G4String unit(end);
+  if (unit.empty())
+  {
+    energy = value * MeV;
+    return true;
+  }
+  if (!G4UnitDefinition::IsUnitDefined(unit) || G4UnitDefinition::GetCategory(unit) != "Energy")
+    return false;
+  energy = value * G4UnitDefinition::GetValueOf(unit);
+  return true;
+}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+RecordFilter *RecordFilter::Instance()
+{
+  static RecordFilter instance;
+  return &instance;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+RecordFilter::RecordFilter()
+{
+  fMessenger = new RecordFilterMessenger(this);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+RecordFilter::~RecordFilter()
+{
+  delete fMessenger;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordFilter::AddRule(const G4String &spec)
+{
+  std::istringstream is(spec);
+  G4String action;
+  is >> action;
+
+  RuleSpec rule;
+  rule.text = spec;
+  if (action == "accept")
+    rule.accept = true;
+  else if (action == "reject")
+    rule.accept = false;
+  else
+    RuleError(spec, "expected accept or reject");
+
+  G4String condition;
+  while (is >> condition)
+  {
+    std::size_t pos = condition.find('=');
+    if (pos == std::string::npos)
+    {
+      RuleError(spec, "expected key=value");
+      return;
+    }
+    G4String key = condition.substr(0, pos);
+    G4String value = condition.substr(pos + 1);
+
+    if (key == "particle")
+    {
+      for (const auto &name : Split(value, ','))
+      {
+        G4int id = ParticleSpecies::FindID(name);
+        if (id == 0)
+          RuleError(spec, "particle " + name + " is never written");
+        rule.particleMask |= 1 << id;
+      }
+    }
+    else if (key == "ekin" || key == "copyNo")
+    {
+      std::vector<G4String> range = Split(value, ':');
+      if (range.size() != 2)
+      {
+        RuleError(spec, "expected " + key + "=min:max");
+        return;
+      }
+      if (key == "ekin")
+      {
+        if (!range[0].empty() && !ParseEnergy(range[0], rule.minEnergy))
+          RuleError(spec, "bad energy " + range[0]);
+        if (!range[1].empty() && !ParseEnergy(range[1], rule.maxEnergy))
+          RuleError(spec, "bad energy " + range[1]);
+      }
+      else
+      {
+        if (!range[0].empty() && !ParseInt(range[0], rule.minCopyNo))
+          RuleError(spec, "bad copyNo " + range[0]);
+        if (!range[1].empty() && !ParseInt(range[1], rule.maxCopyNo))
+          RuleError(spec, "bad copyNo " + range[1]);
+      }
+    }
+    else if (key == "cone")
+    {
+      std::vector<G4String> parts = Split(value, ':');
+      std::vector<G4String> axis = parts.empty() ? parts : Split(parts[0], ',');
+      G4double x, y, z, angle;
+      if (parts.size() != 2 || axis.size() != 3 || !ParseNumber(axis[0], x) || !ParseNumber(axis[1], y) ||
+          !ParseNumber(axis[2], z) || !ParseNumber(parts[1], angle))
+      {
+        RuleError(spec, "expected cone=x,y,z:angle");
+        return;
+      }
+      rule.axis = G4ThreeVector(x, y, z);
+      if (rule.axis.mag2() == 0)
+        RuleError(spec, "cone axis is zero");
+      rule.axis = rule.axis.unit();
+      rule.minCos = std::cos(angle * deg);
+      rule.hasCone = true;
+    }
+    else if (key == "creator")
+      rule.creators = Split(value, ',');
+    else
+      RuleError(spec, "unknown condition " + key);
+  }
+  fRules.push_back(rule);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordFilter::List() const
+{
+  G4cout << "Phase-space filter rules, first match decides:" << G4endl;
+  for (std::size_t i = 0; i < fRules.size(); i++)
+    G4cout << "  " << i << ": " << fRules[i].text << G4endl;
+  G4cout << "  default: " << (fDefaultAccept ? "accept" : "reject") << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::unique_ptr<RecordFilter::Predicate> RecordFilter::Compile() const
+{
+  auto predicate = std::make_unique<Predicate>();
+  predicate->fDefaultAccept = fDefaultAccept;
+
+  G4ProcessTable *processTable = G4ProcessTable::GetProcessTable();
+  for (const RuleSpec &spec : fRules)
+  {
+    Predicate::Rule rule;
+    rule.text = spec.text;
+    rule.accept = spec.accept;
+    rule.particleMask = spec.particleMask;
+    rule.minEnergy = spec.minEnergy;
+    rule.maxEnergy = spec.maxEnergy;
+    rule.minCopyNo = spec.minCopyNo;
+    rule.maxCopyNo = spec.maxCopyNo;
+    rule.hasCone = spec.hasCone;
+    rule.axis = spec.axis;
+    rule.minCos = spec.minCos;
+    rule.hasCreator = !spec.creators.empty();
+    rule.primary = false;
+    rule.matched = 0;
+
+    // a process name stands for its instances for every particle
+    for (const auto &name : spec.creators)
+    {
+      if (name == "primary")
+      {
+        rule.primary = true;
+        continue;
+      }
+      G4ProcessVector *processes = processTable->FindProcesses(name);
+      if (processes->size() == 0)
+      {
+        G4ExceptionDescription msg;
+        msg << "no process named " << name << " in filter rule '" << spec.text << "'";
+        G4Exception("RecordFilter::Compile", "RecordFilter002", JustWarning, msg);
+      }
+      for (std::size_t i = 0; i < processes->size(); i++)
+        rule.creators.push_back((*processes)[i]);
+      delete processes;
+    }
+    predicate->fRules.push_back(rule);
+  }
+  return predicate;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordFilter::Predicate::Merge(const Predicate &other)
+{
+  for (std::size_t i = 0; i < fRules.size() && i < other.fRules.size(); i++)
+    fRules[i].matched += other.fRules[i].matched;
+  fDefaultMatched += other.fDefaultMatched;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RecordFilter::Predicate::Print() const
+{
+  G4long accepted = fDefaultAccept ? fDefaultMatched : 0;
+  G4long rejected = fDefaultAccept ? 0 : fDefaultMatched;
+  G4cout << "Phase-space filter:" << G4endl;
+  for (const Rule &rule : fRules)
+  {
+    G4cout << "  " << rule.text << ": " << rule.matched << (rule.accept ? " accepted" : " rejected") << G4endl;
+    (rule.accept ? accepted : rejected) += rule.matched;
+  }
+  G4cout << "  default " << (fDefaultAccept ? "accept" : "reject") << ": " << fDefaultMatched
+         << (fDefaultAccept ? " accepted" : " rejected") << G4endl;
+  G4cout << "  total " << accepted << " accepted, " << rejected << " rejected" << G4endl;
+}
@@ -0,0 +1,93 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file RecordFilterMessenger.cc
+/// \brief Implementation of the RecordFilterMessenger class
+
+#include "RecordFilterMessenger.hh"
+
+#include "RecordFilter.hh"
+#include "G4UIdirectory.hh"
+#include "G4UIcmdWithAString.hh"
+#include "G4UIcmdWithoutParameter.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RecordFilterMessenger::RecordFilterMessenger(RecordFilter *filter)
+    : G4UImessenger(), fFilter(filter)
+{
+  fFilterDir = new G4UIdirectory("/filter/");
+  fFilterDir->SetGuidance("Rules selecting the phase-space and TrackingData records");
+
+  fRuleCmd = new G4UIcmdWithAString("/filter/rule",this);
+  fRuleCmd->SetGuidance("Append a rule: accept|reject followed by conditions");
+  fRuleCmd->SetGuidance("particle=e-,gamma ekin=min:max copyNo=min:max cone=x,y,z:deg creator=name,primary");
+  fRuleCmd->SetParameterName("rule",false);
+  fRuleCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fRuleCmd->SetToBeBroadcasted(false);
+
+  fDefaultCmd = new G4UIcmdWithAString("/filter/default",this);
+  fDefaultCmd->SetGuidance("Decision for records no rule matches");
+  fDefaultCmd->SetParameterName("decision",false);
+  fDefaultCmd->SetCandidates("accept reject");
+  fDefaultCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fDefaultCmd->SetToBeBroadcasted(false);
+
+  fClearCmd = new G4UIcmdWithoutParameter("/filter/clear",this);
+  fClearCmd->SetGuidance("Remove all rules and accept every record");
+  fClearCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fClearCmd->SetToBeBroadcasted(false);
+
+  fListCmd = new G4UIcmdWithoutParameter("/filter/list",this);
+  fListCmd->SetGuidance("Print the rules");
+  fListCmd->AvailableForStates(G4State_PreInit,G4State_Idle);
+  fListCmd->SetToBeBroadcasted(false);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+RecordFilterMessenger::~RecordFilterMessenger()
+{
+  delete fRuleCmd;
+  delete fDefaultCmd;
+  delete fClearCmd;
+  delete fListCmd;
+  delete fFilterDir;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo......
+
+void RecordFilterMessenger::SetNewValue(G4UIcommand *command, G4String newValue)
+{
+  if (command == fRuleCmd)
+    fFilter->AddRule(newValue);
+  if (command == fDefaultCmd)
+    fFilter->SetDefault(newValue == "accept");
+  if (command == fClearCmd)
+    fFilter->Clear();
+  if (command == fListCmd)
+    fFilter->List();
+}
@@ -25,7 +25,7 @@
 
 #include "RunAction.hh"
 #include "G4Run.hh"
-#include "G4AnalysisManager.hh"
+#include "TrackingDataWriter.hh"
 #include "globals.hh"
 #include <map>
 #include "CommandLineParser.hh"
@@ -33,12 +33,31 @@
 #include "EventAction.hh"
 #include "G4Event.hh"
 #include "DetectorConstruction.hh"
+#include "VoxelScorer.hh"
+#include "PhaseSpaceWriter.hh"
+#include "PhaseSpaceSink.hh"
+#include "G4RunManager.hh"
+#include "G4Threading.hh"
+#include "G4AutoLock.hh"
+#include <algorithm>
+#include "PrimaryGeneratorAction.hh"
+#include "ParameterSweep.hh"
+#include "EventSeed.hh"
+#include "RecordConsumerSet.hh"
+#include "Telemetry.hh"
 #include "git_version.hh"
 #include "G4SystemOfUnits.hh" 
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 using namespace G4DNAPARSER;
 
+namespace
+{
+G4Mutex mergeMutex = G4MUTEX_INITIALIZER;
+}
+
+RunAction *RunAction::fgMasterInstance = nullptr;
+
 RunAction::RunAction()
     : G4UserRunAction()
 {
@@ -48,89 +67,335 @@ RunAction::RunAction()
 
 RunAction::~RunAction()
 {
+    if (fgMasterInstance == this)
+        fgMasterInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool RunAction::ProcessesEvents() const
+{
+    // false only for the master of an MT or tasking run
+    return !IsMaster() || !G4Threading::IsMultithreadedApplication();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
-void RunAction::BeginOfRunAction(const G4Run *)
+void RunAction::BeginOfRunAction(const G4Run *run)
 {
     CommandLineParser *parser = CommandLineParser::GetParser();
     Command *command(0);
+
+    if (auto generator = (PrimaryGeneratorAction *)G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction())
+        generator->ResetCounters();
+    fStepStatistics.Reset();
+    fParticleSpecies.Reset();
+    fEventArena.ResetStatistics();
+    // rules are compiled per thread, against its own process objects
+    fRecordFilter.reset();
+    if (!RecordFilter::Instance()->IsEmpty())
+        fRecordFilter = RecordFilter::Instance()->Compile();
+    fWatchdog = EventWatchdog::Instance()->CreateMonitor();
+    auto voxels = (const DetectorConstruction *)G4RunManager::GetRunManager()->GetUserDetectorConstruction();
+    const VoxelLattice &lattice = voxels->get_lattice();
+    fRecordAndKill = RecordAndKill::Instance()->Compile(lattice.GetSpacing());
+    // shells of the radial placement, for the Info table
+    NumCells.clear();
+    Rmin = Rmax = 0;
+    if (lattice.GetNumShells() > 0)
+    {
+        setRmin(lattice.GetShellRadius(0));
+        setRmax(lattice.GetShellRadius(lattice.GetNumShells() - 1));
+        for (G4int shell = 0; shell < lattice.GetNumShells(); shell++)
+            setNumCells(lattice.GetNumShellCells(shell));
+    }
+    fThreadLoads.clear();
+    fBusyTime = std::chrono::duration<G4double>(0);
+    fRunStart = std::chrono::steady_clock::now();
+    if (IsMaster())
+    {
+        fgMasterInstance = this;
+        Telemetry::BeginOfRun(run->GetRunID(), run->GetNumberOfEventToBeProcessed());
+    }
+
+    if (parser->GetCommandIfActive("-score"))
+    {
+        if (!fVoxelScorer)
+            fVoxelScorer = std::make_unique<VoxelScorer>();
+        fVoxelScorer->Reset(lattice.GetNX(), lattice.GetNY(), lattice.GetNZ());
+        if (IsMaster())
+            VoxelScorer::SetMasterInstance(fVoxelScorer.get());
+    }
+
+    BeginConsumers(run);
+
+    if (!ProcessesEvents())
+        return;
+
     if ((command = parser->GetCommandIfActive("-out")) == 0)
         return;
 
+    OpenPhaseSpaceWriter(command->GetOption());
+
     // Open an output file
-    G4String fileName{"output.root"};
-    if (command->GetOption().empty() == false)
-    {
-        fileName = command->GetOption();
-    }
+    G4String fileName = GetOutputBaseName("output") + ".root";
 
-    G4AnalysisManager *analysisManager = G4AnalysisManager::Instance();
-    analysisManager->SetDefaultFileType("root");
-    analysisManager->SetVerboseLevel(0);
+    G4String backend;
+    if ((command = parser->GetCommandIfActive("-backend")))
+        backend = command->GetOption();
+    if (backend == "none")
+        return;
+    G4int compression{505};
+    if ((command = parser->GetCommandIfActive("-compression")))
+        compression = strtol(command->GetOption(), NULL, 10);
 
-    // open output file
-    //
-    G4bool fileOpen = analysisManager->OpenFile(fileName);
-    if (!fileOpen)
-    {
-        G4cout << "\n---> HistoManager::book(): cannot open " << fileName << G4endl;
+    fTrackingWriter = TrackingDataWriter::Create(backend, compression);
+    if (!fTrackingWriter->Open(fileName))
+        fTrackingWriter.reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RunAction::BeginConsumers(const G4Run *run)
+{
+    if (!RecordConsumerSet::HasLibraries())
         return;
-    }
 
-    G4cout << "\n----> Histogram file is opened in " << fileName << G4endl;
-
-    analysisManager->CreateNtuple("Info", "Info");
-    analysisManager->CreateNtupleDColumn("NumPrimaries");
-    analysisManager->CreateNtupleSColumn("GitHash");
-    analysisManager->FinishNtuple(0);
-
-
-    analysisManager->CreateNtuple("TrackingData", "TrackingData");
-    analysisManager->CreateNtupleIColumn(1, "EventID");
-    analysisManager->CreateNtupleDColumn(1, "particleEnergy_MeV");
-    analysisManager->CreateNtupleDColumn(1, "eDep_MeV");
-    analysisManager->CreateNtupleIColumn(1, "particleID");
-    analysisManager->CreateNtupleIColumn(1, "copyNo");
-    analysisManager->CreateNtupleDColumn(1, "posX");
-    analysisManager->CreateNtupleDColumn(1, "posY");
-    analysisManager->CreateNtupleDColumn(1, "posZ");
-    analysisManager->CreateNtupleDColumn(1, "stepLength");
-    analysisManager->FinishNtuple(1);
+    // instances live as long as the thread's RunAction, across runs
+    if (!fRecordConsumers)
+        fRecordConsumers = std::make_unique<RecordConsumerSet>(fEventArena);
+
+    auto detector = (const DetectorConstruction *)G4RunManager::GetRunManager()->GetUserDetectorConstruction();
+    G4String baseName = GetOutputBaseName("output");
+    ConsumerRunInfo info;
+    info.runID = run->GetRunID();
+    info.isMaster = IsMaster();
+    info.threadID = IsMaster() ? -1 : G4Threading::G4GetThreadId();
+    // numCells x 1 x 1 for the random placement
+    info.ndiv_X = detector->get_lattice().GetNX();
+    info.ndiv_Y = detector->get_lattice().GetNY();
+    info.ndiv_Z = detector->get_lattice().GetNZ();
+    info.spacing = detector->get_spacing();
+    info.voxelHalfSize = detector->get_voxelHalfSize();
+    info.outputBaseName = baseName.c_str();
+    fRecordConsumers->BeginOfRun(info);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RunAction::OpenPhaseSpaceWriter(const G4String &option)
+{
+    // One phase-space file per process, kept open across runs, except that
+    // each configuration of a parameter sweep gets its own file. A stream
+    // stays open for the whole sweep.
+    G4bool stream = PhaseSpaceSink::IsStream(option);
+    if (fPhaseSpaceWriter && (stream || fPhaseSpaceTag == ParameterSweep::GetCurrentTag()))
+        return;
+    fPhaseSpaceWriter.reset();
+    fPhaseSpaceTag = ParameterSweep::GetCurrentTag();
+
+    // Workers write their own file, or fifo, as frames from several threads
+    // would interleave; each worker makes its own unix: connection.
+    G4String fileName = stream ? option : GetOutputBaseName("PSfile");
+    if ((!stream || G4StrUtil::starts_with(option, "fifo:")) && !G4Threading::IsMasterThread())
+        fileName += "_t" + std::to_string(G4Threading::G4GetThreadId());
+    if (!stream)
+        fileName += ".bin";
+
+    G4String format;
+    Command *command = CommandLineParser::GetParser()->GetCommandIfActive("-psformat");
+    if (command)
+        format = command->GetOption();
+    if (format == "none")
+        return;
+
+    auto detector = (const DetectorConstruction *)G4RunManager::GetRunManager()->GetUserDetectorConstruction();
+    std::uint32_t fields = 0;
+    if (CommandLineParser::GetParser()->GetCommandIfActive("-lineage"))
+        fields |= PhaseSpaceWriter::kLineage;
+    if (CommandLineParser::GetParser()->GetCommandIfActive("-psvoxel"))
+        fields |= PhaseSpaceWriter::kVoxel;
+    // ions and other species need their PDG code
+    if (ParticleSpecies::GetRecordedMask() & ~ParticleSpecies::kDefaultMask)
+        fields |= PhaseSpaceWriter::kSpecies;
+    fPhaseSpaceWriter = std::make_unique<PhaseSpaceWriter>(PhaseSpaceWriter::ParseFormat(format),
+                                                           detector->get_voxelHalfSize(), fields);
+    if (!fPhaseSpaceWriter->Open(fileName))
+        fPhaseSpaceWriter.reset();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
 void RunAction::EndOfRunAction(const G4Run *run)
 {
+    if (IsMaster())
+        Telemetry::EndOfRun();
+    WriteVoxelScores(run);
     Write(run);
-    auto fpEventAction = (EventAction *)G4EventManager::GetEventManager()->GetUserEventAction();
 
     G4int numPrimaries = run->GetNumberOfEvent();
+    auto detector = (const DetectorConstruction *)G4RunManager::GetRunManager()->GetUserDetectorConstruction();
+
+    if (!ProcessesEvents())
+    {
+        // workers have already merged into this
+        fStepStatistics.Print(*detector, numPrimaries);
+        fParticleSpecies.Print();
+        if (fRecordFilter)
+            fRecordFilter->Print();
+        fEventArena.PrintStatistics();
+        if (fWatchdog)
+            fWatchdog->Print();
+        if (fRecordAndKill)
+            fRecordAndKill->Print();
+        PrintThreadLoads();
+        if (fRecordConsumers)
+            fRecordConsumers->EndOfRun(numPrimaries);
+        return;
+    }
+
+    if (fRecordConsumers)
+        fRecordConsumers->EndOfRun(numPrimaries);
+
+    if (!IsMaster())
+        MergeIntoMaster(run);
+
+    auto fpEventAction = (EventAction *)G4EventManager::GetEventManager()->GetUserEventAction();
+
+    if (auto generator = (const PrimaryGeneratorAction *)G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction())
+        G4cout << "Source: " << generator->GetNumberOfTries() << " emissions sampled, geometric efficiency "
+               << generator->GetGeometricEfficiency() << G4endl;
+
+    if (IsMaster())
+    {
+        fStepStatistics.Print(*detector, numPrimaries);
+        fParticleSpecies.Print();
+        if (fRecordFilter)
+            fRecordFilter->Print();
+        fEventArena.PrintStatistics();
+        if (fWatchdog)
+            fWatchdog->Print();
+        if (fRecordAndKill)
+            fRecordAndKill->Print();
+    }
 
     G4cout << "Activity of primary = " << numPrimaries*numPrimaries / (fpEventAction->getTotalPrimaryDecayTime() / s) << " s-1" << G4endl;
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
+void RunAction::MergeIntoMaster(const G4Run *run)
+{
+    if (fgMasterInstance == nullptr)
+        return;
+
+    ThreadLoad load;
+    load.threadID = G4Threading::G4GetThreadId();
+    load.numEvents = run->GetNumberOfEvent();
+    load.busySeconds = fBusyTime.count();
+    load.wallSeconds = std::chrono::duration<G4double>(std::chrono::steady_clock::now() - fRunStart).count();
+
+    G4AutoLock lock(&mergeMutex);
+    fgMasterInstance->fStepStatistics.Merge(fStepStatistics);
+    fgMasterInstance->fParticleSpecies.Merge(fParticleSpecies);
+    if (fRecordFilter && fgMasterInstance->fRecordFilter)
+        fgMasterInstance->fRecordFilter->Merge(*fRecordFilter);
+    if (fRecordConsumers && fgMasterInstance->fRecordConsumers)
+        fgMasterInstance->fRecordConsumers->Merge(*fRecordConsumers);
+    fgMasterInstance->fEventArena.MergeStatistics(fEventArena);
+    if (fWatchdog && fgMasterInstance->fWatchdog)
+        fgMasterInstance->fWatchdog->Merge(*fWatchdog);
+    if (fRecordAndKill && fgMasterInstance->fRecordAndKill)
+        fgMasterInstance->fRecordAndKill->Merge(*fRecordAndKill);
+    fgMasterInstance->fThreadLoads.push_back(load);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RunAction::PrintThreadLoads() const
+{
+    if (fThreadLoads.empty())
+        return;
+
+    std::vector<ThreadLoad> loads = fThreadLoads;
+    std::sort(loads.begin(), loads.end(),
+              [](const ThreadLoad &a, const ThreadLoad &b) { return a.threadID < b.threadID; });
+
+    G4double runSeconds = std::chrono::duration<G4double>(std::chrono::steady_clock::now() - fRunStart).count();
+    G4double totalBusy = 0;
+    G4double maxBusy = 0;
+    G4cout << "Thread load (run wall time " << runSeconds << " s):" << G4endl;
+    for (const auto &load : loads)
+    {
+        // idle counts from the start of the master's run to the end of the
+        // worker's, so it includes waiting for work as well as start-up
+        G4double idle = std::max(0., runSeconds - load.busySeconds);
+        G4cout << "  thread " << load.threadID << ": " << load.numEvents << " events, busy "
+               << load.busySeconds << " s, idle " << idle << " s ("
+               << (runSeconds > 0 ? 100*load.busySeconds/runSeconds : 0.) << "% busy)" << G4endl;
+        totalBusy += load.busySeconds;
+        maxBusy = std::max(maxBusy, load.busySeconds);
+    }
+    G4double meanBusy = totalBusy / loads.size();
+    G4cout << "  imbalance (max/mean busy time) " << (meanBusy > 0 ? maxBusy/meanBusy : 0.) << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 void RunAction::Write(const G4Run* run)
 {
-    CommandLineParser *parser = CommandLineParser::GetParser();
-    Command *command(0);
-    if ((command = parser->GetCommandIfActive("-out")) == 0)
+    if (!fTrackingWriter)
         return;
-    G4AnalysisManager *analysisManager = G4AnalysisManager::Instance();
 
+    RunInfo info;
+    info.numPrimaries = run->GetNumberOfEvent();
+    info.gitHash = kGitHash;
+    info.masterSeed = EventSeed::GetMasterSeed();
+    if (fWatchdog)
+        info.skippedEvents = fWatchdog->GetSkippedEvents();
+    info.rMin = Rmin;
+    info.rMax = Rmax;
+    info.cellsPerShell = NumCells;
+    if (auto generator = (const PrimaryGeneratorAction *)G4RunManager::GetRunManager()->GetUserPrimaryGeneratorAction())
+        info.geometricEfficiency = generator->GetGeometricEfficiency();
 
-    analysisManager->FillNtupleDColumn(0,0, run->GetNumberOfEvent());
-    analysisManager->FillNtupleSColumn(0,1, kGitHash);
-    analysisManager->AddNtupleRow(0);
+    fTrackingWriter->Close(info);
+    fTrackingWriter.reset();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void RunAction::WriteVoxelScores(const G4Run *run)
+{
+    if (!fVoxelScorer)
+        return;
 
-    analysisManager->Write();
-    analysisManager->CloseFile();
-    analysisManager->Clear();
-    G4cout << "\n----> Histograms are saved" << G4endl;
+    if (!IsMaster())
+    {
+        // worker scores are merged before the master's end of run
+        if (VoxelScorer::GetMasterInstance())
+            VoxelScorer::GetMasterInstance()->Merge(*fVoxelScorer);
+        return;
+    }
+
+    G4String fileName = GetOutputBaseName("output");
+
+    fVoxelScorer->Write(fileName + "_voxels.bin", run->GetNumberOfEvent());
 }
 
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4String RunAction::GetOutputBaseName(const G4String &defaultName) const
+{
+    // the -out name without extension, or defaultName, plus the sweep tag
+    G4String name = defaultName;
+    Command *command = CommandLineParser::GetParser()->GetCommandIfActive("-out");
+    if (command && command->GetOption().empty() == false && !PhaseSpaceSink::IsStream(command->GetOption()))
+    {
+        name = command->GetOption();
+        if (G4StrUtil::ends_with(name, ".root"))
+            name.erase(name.size() - 5);
+    }
+    return name + ParameterSweep::GetCurrentTag();
+}
@@ -0,0 +1,76 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StackingAction.cc
+/// \brief Implementation of the StackingAction class
+
+#include "StackingAction.hh"
+#include "TrackInformation.hh"
+#include "G4Track.hh"
+#include "G4Event.hh"
+#include "G4EventManager.hh"
+#include "G4VProcess.hh"
+#include "G4HadronicProcessType.hh"
+#include "G4Version.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+StackingAction::StackingAction()
+    : G4UserStackingAction()
+{
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+StackingAction::~StackingAction()
+{
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4ClassificationOfNewTrack StackingAction::ClassifyNewTrack(const G4Track *track)
+{
+  if (track->GetParentID() == 0)
+    return fUrgent;
+
+  const G4VProcess *creator = track->GetCreatorProcess();
+  if (creator == nullptr || creator->GetProcessSubType() != fRadioactiveDecay)
+    return fUrgent;
+
+  // The sub-event's G4Event has its own ID, so keep the parent's on the
+  // track. Decay products inside a sub-event already carry it.
+  if (track->GetUserInformation() == nullptr)
+  {
+    G4int eventID = G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID();
+    ((G4Track *)track)->SetUserInformation(new TrackInformation(eventID));
+  }
+
+#if G4VERSION_NUMBER >= 1120
+  return fSubEvent_0;
+#else
+  return fUrgent;
+#endif
+}
@@ -0,0 +1,80 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file StepStatistics.cc
+/// \brief Implementation of the StepStatistics class
+
+#include "StepStatistics.hh"
+#include "G4UserLimits.hh"
+#include "G4Track.hh"
+#include "G4UnitsTable.hh"
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void StepStatistics::Reset()
+{
+  for (G4int i = 0; i < DetectorConstruction::kNumVolumeClasses; i++)
+    fSteps[i] = fLimitedSteps[i] = fKilledTracks[i] = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void StepStatistics::Merge(const StepStatistics &other)
+{
+  for (G4int i = 0; i < DetectorConstruction::kNumVolumeClasses; i++)
+  {
+    fSteps[i] += other.fSteps[i];
+    fLimitedSteps[i] += other.fLimitedSteps[i];
+    fKilledTracks[i] += other.fKilledTracks[i];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void StepStatistics::Print(const DetectorConstruction &detector, G4int numEvents) const
+{
+  // G4UserLimits needs a track to return its values; the defaults ignore it
+  G4Track dummyTrack;
+
+  G4cout << "Steps per volume class (" << numEvents << " events):" << G4endl;
+  for (G4int i = 0; i < DetectorConstruction::kNumVolumeClasses; i++)
+  {
+    auto volumeClass = (DetectorConstruction::VolumeClass)i;
+    G4UserLimits *limits = detector.get_userLimits(volumeClass);
+
+    G4cout << "  " << DetectorConstruction::GetVolumeClassName(volumeClass) << ": "
+           << fSteps[i] << " steps";
+    if (numEvents > 0)
+      G4cout << " (" << (G4double)fSteps[i] / numEvents << " per event)";
+    G4cout << ", " << fLimitedSteps[i] << " limited by maxStep, "
+           << fKilledTracks[i] << " tracks killed by cuts" << G4endl;
+
+    G4cout << "    maxStep " << G4BestUnit(limits->GetMaxAllowedStep(dummyTrack), "Length")
+           << ", maxTrackLength " << G4BestUnit(limits->GetUserMaxTrackLength(dummyTrack), "Length")
+           << ", maxTime " << G4BestUnit(limits->GetUserMaxTime(dummyTrack), "Time")
+           << ", minEkin " << G4BestUnit(limits->GetUserMinEkine(dummyTrack), "Energy") << G4endl;
+  }
+}
@@ -25,7 +25,6 @@
 //
 //
 #include "SteppingAction.hh"
-#include "G4AnalysisManager.hh"
 #include "G4SystemOfUnits.hh"
 #include "G4Track.hh"
 #include <map>
@@ -36,9 +35,80 @@
 #include "DetectorConstruction.hh"
 #include "CommandLineParser.hh"
 #include "EventAction.hh"
+#include "VoxelScorer.hh"
+#include "VoxelEntryRecord.hh"
+#include "TrackingDataWriter.hh"
+#include "PhaseSpaceWriter.hh"
 #include "G4Ions.hh"
+#include "TrackInformation.hh"
+#include "RecordConsumerSet.hh"
+#include "ParticleSpecies.hh"
+#include "G4AntiNeutrinoE.hh"
 
 using namespace G4DNAPARSER;
+
+namespace
+{
+template <unsigned Sinks>
+class SteppingActionFor : public SteppingAction
+{
+public:
+  void UserSteppingAction(const G4Step *step) override
+  {
+    if (!BeginStep(step))
+      return;
+    // records are built for the output files and the -consumer plugins
+    if constexpr (Sinks != 0)
+      RecordStep<Sinks>(step);
+  }
+};
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+unsigned SteppingAction::GetOutputSinks()
+{
+  CommandLineParser *parser = CommandLineParser::GetParser();
+  unsigned sinks = 0;
+  if (parser->GetCommandIfActive("-out"))
+  {
+    Command *format = parser->GetCommandIfActive("-psformat");
+    if (format == nullptr || format->GetOption() != "none")
+      sinks |= kPhaseSpaceOutput;
+    Command *backend = parser->GetCommandIfActive("-backend");
+    if (backend == nullptr || backend->GetOption() != "none")
+      sinks |= kTrackingOutput;
+  }
+  if (RecordConsumerSet::HasLibraries())
+    sinks |= kConsumerOutput;
+  return sinks;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+SteppingAction *SteppingAction::Create(unsigned sinks)
+{
+  switch (sinks)
+  {
+  case 0:
+    return new SteppingActionFor<0>();
+  case kPhaseSpaceOutput:
+    return new SteppingActionFor<kPhaseSpaceOutput>();
+  case kTrackingOutput:
+    return new SteppingActionFor<kTrackingOutput>();
+  case kPhaseSpaceOutput | kTrackingOutput:
+    return new SteppingActionFor<kPhaseSpaceOutput | kTrackingOutput>();
+  case kConsumerOutput:
+    return new SteppingActionFor<kConsumerOutput>();
+  case kPhaseSpaceOutput | kConsumerOutput:
+    return new SteppingActionFor<kPhaseSpaceOutput | kConsumerOutput>();
+  case kTrackingOutput | kConsumerOutput:
+    return new SteppingActionFor<kTrackingOutput | kConsumerOutput>();
+  default:
+    return new SteppingActionFor<kPhaseSpaceOutput | kTrackingOutput | kConsumerOutput>();
+  }
+}
+
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
 SteppingAction::SteppingAction()
@@ -46,201 +116,227 @@ SteppingAction::SteppingAction()
 {
   fpEventAction = (EventAction *)G4EventManager::GetEventManager()->GetUserEventAction();
   fRunAction = (RunAction *)(G4RunManager::GetRunManager()->GetUserRunAction());
-
-  CommandLineParser *parser = CommandLineParser::GetParser();
-  Command *command(0);
-  G4String fileName{"PSfile.bin"};
-  if ((command = parser->GetCommandIfActive("-out")) != 0)
-
-    if (command->GetOption().empty() == false)
-    {
-      fileName = command->GetOption() + ".bin";
-    }
-
-  PSfile.open(fileName, std::ios::out | std::ios::binary);
+  fDetector = (const DetectorConstruction *)G4RunManager::GetRunManager()->GetUserDetectorConstruction();
+  fTelemetry = Telemetry::GetThreadCounters();
+  if (Command *command = CommandLineParser::GetParser()->GetCommandIfActive("-firstentry"))
+    fFirstEntry = ParseFirstEntryMode(command->GetOption());
+  fSpeciesMask = ParticleSpecies::GetRecordedMask();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
 SteppingAction::~SteppingAction()
 {
-  PSfile.close();
 }
 
 //....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
-void SteppingAction::UserSteppingAction(const G4Step *step)
+
+SteppingAction::FirstEntryMode SteppingAction::ParseFirstEntryMode(const G4String &name)
 {
-  // G4cout << "start of step" << G4endl;
+  if (name.empty() || name == "layer")
+    return kFirstPerLayer;
+  if (name == "lattice")
+    return kFirstPerLattice;
+  if (name == "all")
+    return kAllEntries;
+
+  G4ExceptionDescription description;
+  description << "Unknown first-entry mode \"" << name << "\", use layer, lattice or all." << G4endl;
+  G4Exception("SteppingAction::ParseFirstEntryMode", "SteppingAction001", FatalException, description);
+  return kAllEntries;
+}
 
-  if (step->GetTrack()->GetParticleDefinition()->GetParticleName() == "anti_nu_e") // not anti neutrinos
-    return;
-  G4double dE = step->GetTotalEnergyDeposit();
-  G4String particleName = step->GetTrack()->GetParticleDefinition()->GetParticleName();
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
-  // if (step->GetPreStepPoint() != nullptr)
-  // {
-    // G4cout << particleName << " " << step->GetTrack()->GetTrackID() << " " << step->GetPreStepPoint()->GetPhysicalVolume()->GetName() << " " << step->GetPostStepPoint()->GetPhysicalVolume()->GetName() << G4endl;
-    // G4cout << particleName << " " << step->GetPreStepPoint()->GetKineticEnergy() << " " << step->GetPostStepPoint()->GetPhysicalVolume()->GetName() << " " << step->GetPostStepPoint()->GetPosition()<< G4endl;
-  // }
+void SteppingAction::Score(const G4Step *step, VoxelScorer *scorer)
+{
+  // deposit and track length go to the voxel the step was taken in,
+  // entries to the voxel the particle is crossing into
+  G4int voxelID = fDetector->get_voxelID(step->GetPreStepPoint()->GetPhysicalVolume());
+  if (voxelID >= 0)
+    scorer->AddStep(voxelID, step->GetTotalEnergyDeposit(), step->GetStepLength());
 
-  if (step->GetPreStepPoint()->GetPhysicalVolume()->GetName() == "water")
+  if (step->GetPostStepPoint()->GetStepStatus() == fGeomBoundary)
   {
-    if (step->GetPostStepPoint()->GetPhysicalVolume()->GetName() == "world")
-    {
-      step->GetTrack()->SetTrackStatus(fStopAndKill);
-
+    G4VPhysicalVolume *postVolume = step->GetPostStepPoint()->GetPhysicalVolume();
+    if (postVolume == nullptr)
       return;
-    }
+    G4int entryID = fDetector->get_voxelID(postVolume);
+    if (entryID >= 0)
+      scorer->AddEntry(entryID);
   }
+}
 
-  CommandLineParser *parser = CommandLineParser::GetParser();
-  Command *command(0);
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
-  if ((command = parser->GetCommandIfActive("-out")) == 0)
-    return;
+// Counts a voxel entry of the current track; false if -firstentry drops it.
+// The test is geometric, so it runs before the /filter/ rules: a track whose
+// first entry in a layer was filtered out is not recorded later in that layer.
+G4bool SteppingAction::CountEntry(G4int layer)
+{
+  fTrackEntries++;
+  if (fFirstEntry == kFirstPerLattice)
+    return fTrackEntries == 1;
+  if (fFirstEntry == kFirstPerLayer)
+  {
+    if ((std::size_t)layer >= fLayerTrack.size())
+      fLayerTrack.resize(layer + 1, 0);
+    if (fLayerTrack[layer] == fTrackSerial)
+      return false;
+    fLayerTrack[layer] = fTrackSerial;
+  }
+  return true;
+}
 
-  if (step->GetPreStepPoint() == nullptr) // is this right????
-    return;
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
-  G4String volumeNamePre = step->GetPreStepPoint()->GetPhysicalVolume()->GetName();
+G4bool SteppingAction::BeginStep(const G4Step *step)
+{
+  if (fTelemetry)
+    Telemetry::Counters::Add(fTelemetry->steps);
+  DetectorConstruction::VolumeClass preClass =
+      fDetector->get_volumeClass(step->GetPreStepPoint()->GetPhysicalVolume()->GetLogicalVolume());
+  fRunAction->GetStepStatistics().Count(preClass, step->GetPostStepPoint()->GetProcessDefinedStep());
+
+  if (EventWatchdog::Monitor *watchdog = fRunAction->GetWatchdog())
+    if (watchdog->Step(step)) // event aborted, over budget
+      return false;
+
+  if (step->GetTrack()->GetCurrentStepNumber() == 1) // a new track
+  {
+    fTrackEntries = 0;
+    fTrackSerial++;
+  }
+  if (RecordAndKill::Policy *kill = fRunAction->GetRecordAndKill())
+    kill->Step(step);
 
-  if (volumeNamePre == "water") // particle from water volume entering the cell - save details in PS file
+  // classes come from the logical volumes' limits, no name compares per step;
+  // the layer and row mothers are water too but lie inside the water box
+  if (preClass == DetectorConstruction::kWaterVolume)
   {
-    if (step->GetPostStepPoint()->GetPhysicalVolume()->GetName() == "voxel") // last step before entering cell
+    const G4LogicalVolume *postVolume = step->GetPostStepPoint()->GetPhysicalVolume()->GetLogicalVolume();
+    if (fDetector->get_volumeClass(postVolume) == DetectorConstruction::kWorldVolume)
     {
-      
-      G4TouchableHandle theTouchable = step->GetPostStepPoint()->GetTouchableHandle();
-      G4ThreeVector worldPos = step->GetPostStepPoint()->GetPosition();
-      G4ThreeVector localPos = theTouchable->GetHistory()->GetTopTransform().TransformPoint(worldPos);
-
-      G4ThreeVector worldMomentum = step->GetPostStepPoint()->GetMomentumDirection();
-      //G4ThreeVector localMomentum = (*(theTouchable->GetHistory()->GetTopVolume()->GetRotation()))*worldMomentum; // rotate momentum direction by volume rotation
-
-      G4double time = step->GetPostStepPoint()->GetGlobalTime();
-
-      auto particleEnergy = step->GetPostStepPoint()->GetKineticEnergy();
-      G4int eventID = G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID();
-
-      G4String particleName = step->GetTrack()->GetParticleDefinition()->GetParticleName();
-      G4int copyNo = step->GetPostStepPoint()->GetPhysicalVolume()->GetCopyNo();
-      G4double steplength = step->GetStepLength();
-
-      G4float particleID{0};
-      if (G4StrUtil::contains(particleName,"e-"))
-        particleID = 1;
-      else if (G4StrUtil::contains(particleName,"gamma"))
-        particleID = 2;
-      else if (G4StrUtil::contains(particleName,"alpha"))
-        particleID = 3;
-      else if (G4StrUtil::contains(particleName,"proton"))
-        particleID = 4;
-      else
-      {
-        G4cout << particleName << " outside  not saved" << G4endl;
-        return;
-      }
-
-      //G4cout << "particle " << particleID << " in layer " << copyNo << G4endl;
-      float output[12];
-      output[0] = localPos.x() / mm;
-      output[1] = localPos.y() / mm;
-      output[2] = localPos.z() / mm;
-      output[3] = worldMomentum.x();
-      output[4] = worldMomentum.y();
-      output[5] = worldMomentum.z();
-      output[6] = particleEnergy / MeV;
-      output[7] = eventID;
-      output[8] = particleID;
-      output[9] = copyNo;
-      output[10] = time / s;
-      output[11] = ((const G4Ions*)( step->GetTrack()->GetParticleDefinition()))->GetExcitationEnergy();
-
-      PSfile.write((char *)&output, sizeof(output));
-
-      G4AnalysisManager *analysisManager = G4AnalysisManager::Instance();
-
-      analysisManager->FillNtupleIColumn(1, 0, eventID);
-      analysisManager->FillNtupleDColumn(1, 1, particleEnergy / MeV);
-      analysisManager->FillNtupleDColumn(1, 2, dE / MeV);
-      analysisManager->FillNtupleIColumn(1, 3, particleID);
-      analysisManager->FillNtupleIColumn(1, 4, copyNo);
-      analysisManager->FillNtupleDColumn(1, 5, worldPos.x() / nanometer);
-      analysisManager->FillNtupleDColumn(1, 6, worldPos.y() / nanometer);
-      analysisManager->FillNtupleDColumn(1, 7, worldPos.z() / nanometer);
-      analysisManager->FillNtupleDColumn(1, 8, steplength);
-      analysisManager->AddNtupleRow(1);
-
-    
+      step->GetTrack()->SetTrackStatus(fStopAndKill);
+
+      return false;
     }
   }
 
-  if ((volumeNamePre == "voxel") && (step->IsFirstStepInVolume())) // save particles created in the cell or nucleus
-  {
+  // anti neutrinos deposit nothing, they only go on to be recorded or
+  // counted as skipped
+  if (VoxelScorer *scorer = fRunAction->GetVoxelScorer())
+    if (step->GetTrack()->GetParticleDefinition() != G4AntiNeutrinoE::Definition())
+      Score(step, scorer);
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+template <unsigned Sinks>
+void SteppingAction::RecordStep(const G4Step *step)
+{
+  const G4VPhysicalVolume *preVolume = step->GetPreStepPoint()->GetPhysicalVolume();
 
+  if (fDetector->get_voxelID(preVolume) >= 0)
+  {
+    // save particles created in the cell or nucleus
+    if (!step->IsFirstStepInVolume())
+      return;
     if (step->GetPreStepPoint()->GetProcessDefinedStep() != nullptr)
       return; // if prestep process is nullptr this is the first step of particle created by interaction in the cell - only save those created by processes in cell
 
     if (step->GetTrack()->GetCreatorProcess()->GetProcessName() != "RadioactiveDecay")
       return; // only save products of radioactive decay other products are from parents which are saved on entering the cell and will be tracked in DNA simulation.
 
+    RecordAt<Sinks, true>(step, step->GetPreStepPoint());
+  }
+  // particle from water (or a layer/row mother of the hierarchical layout) entering the cell - save details in PS file
+  else if (fDetector->get_volumeClass(preVolume->GetLogicalVolume()) != DetectorConstruction::kWorldVolume)
+  {
+    if (fDetector->get_voxelID(step->GetPostStepPoint()->GetPhysicalVolume()) >= 0) // last step before entering cell
+      RecordAt<Sinks, false>(step, step->GetPostStepPoint());
+  }
+}
 
-    G4TouchableHandle theTouchable = step->GetPreStepPoint()->GetTouchableHandle();
-    G4ThreeVector worldPos = step->GetPreStepPoint()->GetPosition();
-    G4ThreeVector localPos = theTouchable->GetHistory()->GetTopTransform().TransformPoint(worldPos);
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
-    G4ThreeVector worldMomentum = step->GetPreStepPoint()->GetMomentumDirection();
-    G4ThreeVector localMomentum = (*(theTouchable->GetHistory()->GetTopVolume()->GetRotation()))*worldMomentum;
+template <unsigned Sinks, G4bool Created>
+void SteppingAction::RecordAt(const G4Step *step, const G4StepPoint *point)
+{
+  const G4ParticleDefinition *particle = step->GetTrack()->GetParticleDefinition();
+  G4int particleID = ParticleSpecies::GetID(particle);
+  if (!(fSpeciesMask & (1 << particleID)))
+  {
+    fRunAction->GetParticleSpecies().CountSkipped(particle, Created);
+    return;
+  }
 
-    G4double time = step->GetPreStepPoint()->GetGlobalTime();
+  // voxel coordinates from the lattice, no touchable history needed; a
+  // created particle is in the pre-step voxel, the post-step volume may
+  // already be the water
+  const VoxelLattice &lattice = fDetector->get_lattice();
+  G4int voxelID = fDetector->get_voxelID(point->GetPhysicalVolume());
+  G4ThreeVector worldPos = point->GetPosition();
+  // voxels are unrotated, local and world directions are the same
+  G4ThreeVector direction = point->GetMomentumDirection();
+  G4int copyNo = lattice.GetCopyNo(voxelID);
+  G4int entry = fTrackEntries; // always 0 when created, the track starts here
+  if (!CountEntry(copyNo))
+    return;
+  if (RecordFilter::Predicate *filter = fRunAction->GetRecordFilter())
+    if (!filter->Accept(particleID, point->GetKineticEnergy(), copyNo, direction,
+                        step->GetTrack()->GetCreatorProcess()))
+      return;
 
-    auto particleEnergy = step->GetPreStepPoint()->GetKineticEnergy();
-    G4int eventID = G4EventManager::GetEventManager()->GetConstCurrentEvent()->GetEventID();
+  VoxelEntryRecord record;
+  record.worldPosition = worldPos;
+  record.localPosition = lattice.ToLocal(worldPos, voxelID);
+  record.direction = direction;
+  record.globalTime = point->GetGlobalTime();
+  record.kineticEnergy = point->GetKineticEnergy();
+  record.energyDeposit = step->GetTotalEnergyDeposit();
+  record.stepLength = step->GetStepLength();
+  if (particleID == ParticleSpecies::kAlpha || particleID == ParticleSpecies::kIon) // G4Ions
+    record.excitationEnergy = ((const G4Ions*)particle)->GetExcitationEnergy();
+  record.eventID = TrackInformation::GetEventID(step->GetTrack());
+  record.particleID = particleID;
+  record.pdg = particle->GetPDGEncoding();
+  lattice.GetIndices(voxelID, record.voxelI, record.voxelJ, record.copyNo);
+  record.trackID = step->GetTrack()->GetTrackID();
+  record.parentID = step->GetTrack()->GetParentID();
+  record.entry = entry;
+
+  Record<Sinks>(record);
+  // An entering particle is stopped on the boundary, the secondaries of the
+  // step are in the water. Those of a created particle's first step are in
+  // the voxel, the DNA stage makes them again.
+  if (RecordAndKill::Policy *kill = fRunAction->GetRecordAndKill())
+    if (kill->Kill(record, step, Created))
+      step->GetTrack()->SetTrackStatus(Created ? fKillTrackAndSecondaries : fStopAndKill);
+}
 
-    G4String particleName = step->GetTrack()->GetParticleDefinition()->GetParticleName();
-    G4int copyNo = step->GetPostStepPoint()->GetPhysicalVolume()->GetCopyNo();
-    G4double steplength = step->GetStepLength();
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
 
-    G4float particleID{0};
-    if (G4StrUtil::contains(particleName,"e-"))
-      particleID = 1;
-    else if (G4StrUtil::contains(particleName,"gamma"))
-      particleID = 2;
-    else if (G4StrUtil::contains(particleName,"alpha"))
-      particleID = 3;
-    else
-    {
-      G4cout << particleName << " inside  not saved" << G4endl;
-      return;
-    }
+template <unsigned Sinks>
+void SteppingAction::Record(const VoxelEntryRecord &record)
+{
+  // a sink may still be missing, if its file did not open
+  if constexpr ((Sinks & kPhaseSpaceOutput) != 0)
+    if (PhaseSpaceWriter *psWriter = fRunAction->GetPhaseSpaceWriter())
+      psWriter->Write(record);
 
-    float output[12];
-    output[0] = localPos.x() / mm;
-    output[1] = localPos.y() / mm;
-    output[2] = localPos.z() / mm;
-    output[3] = localMomentum.x();
-    output[4] = localMomentum.y();
-    output[5] = localMomentum.z();
-    output[6] = particleEnergy / MeV;
-    output[7] = eventID;
-    output[8] = particleID;
-    output[9] = copyNo;
-    output[10] = time / s;
-    output[11] = ((const G4Ions*)( step->GetTrack()->GetParticleDefinition()))->GetExcitationEnergy();
-
-    PSfile.write((char *)&output, sizeof(output));
-
-    G4AnalysisManager *analysisManager = G4AnalysisManager::Instance();
-
-    analysisManager->FillNtupleDColumn(1, 1, particleEnergy / MeV);
-    analysisManager->FillNtupleDColumn(1, 2, dE / MeV);
-    analysisManager->FillNtupleIColumn(1, 3, particleID);
-    analysisManager->FillNtupleIColumn(1, 4, copyNo);
-    analysisManager->FillNtupleDColumn(1, 5, worldPos.x() / nanometer);
-    analysisManager->FillNtupleDColumn(1, 6, worldPos.y() / nanometer);
-    analysisManager->FillNtupleDColumn(1, 7, worldPos.z() / nanometer);
-    analysisManager->FillNtupleDColumn(1, 8, steplength);
-    analysisManager->AddNtupleRow(1);
-  }
+  if constexpr ((Sinks & kTrackingOutput) != 0)
+    if (TrackingDataWriter *writer = fRunAction->GetTrackingWriter())
+      writer->Fill(record);
 
-}
+  if constexpr ((Sinks & kConsumerOutput) != 0)
+    if (RecordConsumerSet *consumers = fRunAction->GetRecordConsumers())
+      consumers->Add(record);
 
+  if (RecordAndKill::Policy *kill = fRunAction->GetRecordAndKill())
+    kill->CountRecord();
+
+  if (fTelemetry)
+    Telemetry::Counters::Add(fTelemetry->records);
+}
@@ -0,0 +1,238 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+//
+/// \file SteppingBenchmark.cc
+/// \brief Implementation of the SteppingBenchmark class
+
+#include "SteppingBenchmark.hh"
+
+// only in alphaBeamStepBenchmark (cmake -DWITH_STEPPING_BENCHMARK=ON): the
+// counting operator new below replaces the global allocator
+#ifdef ALPHABEAM_STEPPING_BENCHMARK
+
+#include "DetectorConstruction.hh"
+#include "CommandLineParser.hh"
+#include "RunAction.hh"
+#include "SteppingAction.hh"
+#include "G4DynamicParticle.hh"
+#include "G4Electron.hh"
+#include "G4Navigator.hh"
+#include "G4PhysicalVolumeStore.hh"
+#include "G4RunManager.hh"
+#include "G4Step.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4TouchableHistory.hh"
+#include "G4Track.hh"
+#include "G4TransportationManager.hh"
+#include "G4VDiscreteProcess.hh"
+#include <atomic>
+#include <cfloat>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <new>
+
+using namespace G4DNAPARSER;
+
+namespace
+{
+// heap allocations of each thread, for the allocations per step
+thread_local G4long tlsAllocations = 0;
+
+std::atomic<G4int> gRequestedSteps{0};
+
+// creator of the decay case; SteppingAction only looks at the name
+class FixtureDecay : public G4VDiscreteProcess
+{
+public:
+  FixtureDecay() : G4VDiscreteProcess("RadioactiveDecay", fDecay) {}
+  G4double GetMeanFreePath(const G4Track &, G4double, G4ForceCondition *) override { return DBL_MAX; }
+};
+
+G4TouchableHandle Locate(G4Navigator &navigator, const G4ThreeVector &position)
+{
+  navigator.LocateGlobalPointAndSetup(position, nullptr, false, true);
+  return G4TouchableHandle(navigator.CreateTouchableHistory());
+}
+}
+
+void *operator new(std::size_t size)
+{
+  ++tlsAllocations;
+  if (void *p = std::malloc(size ? size : 1))
+    return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept
+{
+  std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+  std::free(p);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void SteppingBenchmark::Request(G4int numSteps)
+{
+  gRequestedSteps = numSteps;
+  G4RunManager::GetRunManager()->BeamOn(1);
+  gRequestedSteps = 0;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void SteppingBenchmark::RunIfRequested()
+{
+  G4int numSteps = gRequestedSteps.exchange(0);
+  if (numSteps <= 0)
+    return;
+
+  // The synthetic steps would end up in real outputs and counters, and
+  // the watchdog could abort the timed loop.
+  CommandLineParser *parser = CommandLineParser::GetParser();
+  auto runAction = (RunAction *)G4RunManager::GetRunManager()->GetUserRunAction();
+  if (SteppingAction::GetOutputSinks() != 0 || parser->GetCommandIfActive("-score") ||
+      parser->GetCommandIfActive("-telemetry") || runAction->GetWatchdog() || runAction->GetRecordAndKill())
+  {
+    G4Exception("SteppingBenchmark::RunIfRequested", "SteppingBenchmark002", JustWarning,
+                "The stepping benchmark runs without -out, -consumer, -score, -telemetry, "
+                "the watchdog and /kill/, nothing timed");
+    return;
+  }
+
+  G4cout << "Stepping benchmark: " << numSteps << " steps per case" << G4endl;
+  for (const Result &result : Run(numSteps))
+    G4cout << "  " << result.name << ": " << 1e9 * result.seconds / result.numSteps << " ns/step, "
+           << (G4double)result.allocations / result.numSteps << " allocations/step" << G4endl;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::vector<SteppingBenchmark::Result> SteppingBenchmark::Run(G4int numSteps)
+{
+  std::vector<Result> results;
+  auto detector = (const DetectorConstruction *)G4RunManager::GetRunManager()->GetUserDetectorConstruction();
+  // every sink compiled in; none is open, so records are built and dropped
+  std::unique_ptr<SteppingAction> action(SteppingAction::Create(SteppingAction::kPhaseSpaceOutput |
+                                                                SteppingAction::kTrackingOutput |
+                                                                SteppingAction::kConsumerOutput));
+  G4VPhysicalVolume *voxel = G4PhysicalVolumeStore::GetInstance()->GetVolume("voxel", false);
+  if (voxel == nullptr || detector->get_voxelID(voxel) < 0)
+  {
+    G4Exception("SteppingBenchmark::Run", "SteppingBenchmark001", JustWarning,
+                "No voxel to run the stepping benchmark with");
+    return results;
+  }
+
+  // a voxel, and points in it, on its -z face and in the water below it
+  const VoxelLattice &lattice = detector->get_lattice();
+  G4ThreeVector centre = lattice.GetCentre(detector->get_voxelID(voxel));
+  G4double halfSize = lattice.GetHalfSize();
+  G4ThreeVector face = centre - G4ThreeVector(0, 0, halfSize);
+  G4ThreeVector below = face - G4ThreeVector(0, 0, 10 * nm);
+  G4ThreeVector up(0, 0, 1);
+
+  G4Navigator navigator;
+  navigator.SetWorldVolume(G4TransportationManager::GetTransportationManager()->GetNavigatorForTracking()->GetWorldVolume());
+  G4TouchableHandle inVoxel = Locate(navigator, centre);
+  G4TouchableHandle inWater = Locate(navigator, below);
+
+  FixtureDecay decay;
+  auto *particle = new G4DynamicParticle(G4Electron::Definition(), up, 100 * keV);
+  G4Track track(particle, 0, below);   // owns the particle
+  track.SetTrackID(2);
+  track.SetParentID(1);
+  track.IncrementCurrentStepNumber(); // stays 1: every step starts a track
+
+  G4Step step;
+  step.SetTrack(&track);
+  track.SetStep(&step);
+  G4StepPoint *pre = step.GetPreStepPoint();
+  G4StepPoint *post = step.GetPostStepPoint();
+  for (G4StepPoint *point : {pre, post})
+  {
+    point->SetMomentumDirection(up);
+    point->SetKineticEnergy(100 * keV);
+    point->SetGlobalTime(1 * ns);
+  }
+  step.SetStepLength(10 * nm);
+  step.SetTotalEnergyDeposit(10 * eV);
+
+  for (const char *name : {"transport", "crossing", "decay"})
+  {
+    const G4String caseName = name;
+    track.SetTrackStatus(fAlive);
+    track.SetCreatorProcess(nullptr);
+    step.ClearFirstStepFlag();
+    pre->SetProcessDefinedStep(nullptr);
+    post->SetProcessDefinedStep(nullptr);
+    if (caseName == "transport")
+    {
+      pre->SetTouchableHandle(inWater);
+      post->SetTouchableHandle(inWater);
+      pre->SetPosition(below - G4ThreeVector(0, 0, 10 * nm));
+      post->SetPosition(below);
+      post->SetStepStatus(fAlongStepDoItProc);
+    }
+    else if (caseName == "crossing")
+    {
+      pre->SetTouchableHandle(inWater);
+      post->SetTouchableHandle(inVoxel);
+      pre->SetPosition(below);
+      post->SetPosition(face);
+      post->SetStepStatus(fGeomBoundary);
+    }
+    else
+    {
+      pre->SetTouchableHandle(inVoxel);
+      post->SetTouchableHandle(inVoxel);
+      pre->SetPosition(centre);
+      post->SetPosition(centre + 10 * nm * up);
+      post->SetStepStatus(fAlongStepDoItProc);
+      track.SetCreatorProcess(&decay);
+      step.SetFirstStepFlag();
+    }
+
+    Result result;
+    result.name = name;
+    result.numSteps = numSteps;
+    G4long allocations = tlsAllocations;
+    auto start = std::chrono::steady_clock::now();
+    for (G4int i = 0; i < numSteps; i++)
+      action->UserSteppingAction(&step);
+    result.seconds = std::chrono::duration<G4double>(std::chrono::steady_clock::now() - start).count();
+    result.allocations = tlsAllocations - allocations;
+    results.push_back(result);
+  }
+  return results;
+}
+
+#endif
@@ -0,0 +1,292 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file Telemetry.cc
+/// \brief Implementation of the Telemetry class
+
+#include "Telemetry.hh"
+#include "G4Threading.hh"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+namespace
+{
+enum RunState { kIdle, kRunning, kFinished };
+const char *runStateNames[] = {"idle", "running", "finished"};
+
+struct Totals
+{
+    G4long events{0};
+    G4long steps{0};
+    G4long records{0};
+    G4long psBytes{0};
+    G4long longestEvent{0};   // ns
+    G4int eventsInProgress{0};
+};
+
+struct State
+{
+    G4String fileName;
+    G4bool prometheus{false};
+    std::chrono::milliseconds interval{10000};
+
+    std::mutex mutex;         // everything below
+    std::condition_variable wakeUp;
+    G4bool stop{false};
+    std::thread thread;
+    std::vector<std::unique_ptr<Telemetry::Counters>> counters; // never shrinks
+
+    RunState runState{kIdle};
+    G4int runID{-1};
+    G4int numEventsToDo{0};
+    G4long runStart{0};
+    Totals atRunStart;
+    Totals previous;
+    G4long previousTime{0};
+};
+
+State *state = nullptr;
+G4ThreadLocal Telemetry::Counters *threadCounters = nullptr;
+
+// caller holds state->mutex
+Totals Sum(G4long now)
+{
+    Totals totals;
+    for (const auto &counters : state->counters)
+    {
+        totals.events += counters->events.load(std::memory_order_relaxed);
+        totals.steps += counters->steps.load(std::memory_order_relaxed);
+        totals.records += counters->records.load(std::memory_order_relaxed);
+        totals.psBytes += counters->psBytes.load(std::memory_order_relaxed);
+        G4long start = counters->eventStart.load(std::memory_order_relaxed);
+        if (start != 0)
+        {
+            totals.eventsInProgress++;
+            totals.longestEvent = std::max(totals.longestEvent, now - start);
+        }
+    }
+    return totals;
+}
+
+G4long ResidentBytes()
+{
+    // second field of statm: resident pages (Linux)
+    std::ifstream statm("/proc/self/statm");
+    G4long size = 0, resident = 0;
+    if (!(statm >> size >> resident))
+        return 0;
+    return resident * sysconf(_SC_PAGESIZE);
+}
+
+// caller holds state->mutex
+void WriteStatus()
+{
+    G4long now = Telemetry::Now();
+    Totals totals = Sum(now);
+
+    G4double interval = (now - state->previousTime) * 1e-9;
+    G4double eventRate = interval > 0 ? (totals.events - state->previous.events) / interval : 0;
+    G4double stepRate = interval > 0 ? (totals.steps - state->previous.steps) / interval : 0;
+    G4double byteRate = interval > 0 ? (totals.psBytes - state->previous.psBytes) / interval : 0;
+    state->previous = totals;
+    state->previousTime = now;
+
+    // ETA from the mean rate of the run so far
+    G4long eventsDone = totals.events - state->atRunStart.events;
+    G4double runSeconds = state->runStart > 0 ? (now - state->runStart) * 1e-9 : 0;
+    G4double eta = -1;
+    if (state->runState == kRunning && eventsDone > 0 && runSeconds > 0)
+        eta = (state->numEventsToDo - eventsDone) / (eventsDone / runSeconds);
+
+    struct Metric
+    {
+        const char *name;
+        G4double value;
+        const char *help;
+    };
+    const Metric metrics[] = {
+        {"run", (G4double)state->runID, "current or last run ID"},
+        {"events_done", (G4double)eventsDone, "events finished in this run"},
+        {"events_to_do", (G4double)state->numEventsToDo, "events requested for this run"},
+        {"events_per_s", eventRate, "over the last interval"},
+        {"eta_s", eta, "at the mean rate of this run, -1 if unknown"},
+        {"steps_per_s", stepRate, "over the last interval"},
+        {"records", (G4double)(totals.records - state->atRunStart.records), "records written in this run"},
+        {"ps_bytes", (G4double)totals.psBytes, "bytes in the open phase-space files"},
+        {"ps_bytes_per_s", byteRate, "over the last interval"},
+        {"rss_bytes", (G4double)ResidentBytes(), "resident set size"},
+        {"events_in_progress", (G4double)totals.eventsInProgress, "threads inside an event"},
+        {"longest_event_s", totals.longestEvent * 1e-9, "elapsed time of the oldest event in progress"},
+        {"run_s", runSeconds, "wall time since the start of the run"},
+    };
+
+    std::ostringstream out;
+    out.precision(12); // counts and byte sizes as integers
+    if (state->prometheus)
+    {
+        out << "# HELP alphabeam_state 0 idle, 1 running, 2 finished\n# TYPE alphabeam_state gauge\n"
+            << "alphabeam_state " << (G4int)state->runState << "\n";
+        for (const auto &metric : metrics)
+            out << "# HELP alphabeam_" << metric.name << " " << metric.help << "\n"
+                << "# TYPE alphabeam_" << metric.name << " gauge\n"
+                << "alphabeam_" << metric.name << " " << metric.value << "\n";
+    }
+    else
+    {
+        out << "{\n  \"state\": \"" << runStateNames[state->runState] << "\",\n  \"time\": " << std::time(nullptr);
+        for (const auto &metric : metrics)
+            out << ",\n  \"" << metric.name << "\": " << metric.value;
+        out << "\n}\n";
+    }
+
+    G4String temporary = state->fileName + ".tmp";
+    std::ofstream file(temporary, std::ios::trunc);
+    file << out.str();
+    file.close();
+    if (!file || std::rename(temporary.c_str(), state->fileName.c_str()) != 0)
+        G4cerr << "Telemetry: cannot write " << state->fileName << G4endl;
+}
+
+void Loop()
+{
+    std::unique_lock<std::mutex> lock(state->mutex);
+    auto next = std::chrono::steady_clock::now();
+    while (!state->stop)
+    {
+        next += state->interval;
+        if (state->wakeUp.wait_until(lock, next, [] { return state->stop; }))
+            break;
+        WriteStatus();
+    }
+}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4long Telemetry::Now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void Telemetry::Start(const G4String &spec)
+{
+    if (state != nullptr)
+        return;
+    state = new State;
+
+    state->fileName = spec;
+    std::size_t colon = spec.rfind(':');
+    if (colon != std::string::npos)
+    {
+        state->fileName = spec.substr(0, colon);
+        G4double seconds = std::strtod(spec.c_str() + colon + 1, nullptr);
+        if (seconds > 0)
+            state->interval = std::chrono::milliseconds((G4long)(seconds * 1000));
+    }
+    state->prometheus = G4StrUtil::ends_with(state->fileName, ".prom");
+    state->previousTime = Now();
+
+    G4cout << "Telemetry: writing " << state->fileName << " every "
+           << state->interval.count() / 1000. << " s" << G4endl;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        WriteStatus();
+    }
+    state->thread = std::thread(Loop);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void Telemetry::Stop()
+{
+    if (state == nullptr)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->stop = true;
+        state->runState = kFinished;
+        WriteStatus();
+    }
+    state->wakeUp.notify_all();
+    state->thread.join();
+    // the counters stay allocated: threads may still hold pointers to them
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+Telemetry::Counters *Telemetry::GetThreadCounters()
+{
+    if (state == nullptr)
+        return nullptr;
+    if (threadCounters == nullptr)
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->counters.push_back(std::make_unique<Counters>());
+        threadCounters = state->counters.back().get();
+    }
+    return threadCounters;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void Telemetry::BeginOfRun(G4int runID, G4int numEvents)
+{
+    if (state == nullptr)
+        return;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->runState = kRunning;
+    state->runID = runID;
+    state->numEventsToDo = numEvents;
+    state->runStart = Now();
+    state->atRunStart = Sum(state->runStart);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void Telemetry::EndOfRun()
+{
+    if (state == nullptr)
+        return;
+    std::lock_guard<std::mutex> lock(state->mutex);
+    state->runState = kIdle;
+    WriteStatus();
+}
@@ -0,0 +1,79 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TrackingDataWriter.cc
+/// \brief Implementation of the TrackingDataWriter class
+
+#include "TrackingDataWriter.hh"
+#include "AnalysisTrackingWriter.hh"
+#include "TreeTrackingWriter.hh"
+#include "RNTupleTrackingWriter.hh"
+#include "G4Exception.hh"
+#include <fstream>
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::unique_ptr<TrackingDataWriter> TrackingDataWriter::Create(const G4String &backend,
+                                                               G4int compression)
+{
+  if (backend.empty() || backend == "g4")
+    return std::make_unique<AnalysisTrackingWriter>();
+
+#ifdef ALPHABEAM_WITH_ROOT
+  if (backend == "tree")
+    return std::make_unique<TreeTrackingWriter>(compression);
+#ifdef ALPHABEAM_WITH_RNTUPLE
+  if (backend == "rntuple")
+    return std::make_unique<RNTupleTrackingWriter>(compression);
+#endif
+#else
+  (void)compression;
+#endif
+
+  G4ExceptionDescription description;
+  description << "Output backend \"" << backend << "\" is unknown or was not built "
+              << "(ROOT backends need WITH_ROOT_OUTPUT=ON)." << G4endl;
+  G4Exception("TrackingDataWriter::Create", "TrackingDataWriter001",
+              FatalException, description);
+  return nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void TrackingDataWriter::PrintThroughput(const G4String &backend,
+                                         const G4String &fileName) const
+{
+  std::ifstream file(fileName, std::ios::in | std::ios::binary | std::ios::ate);
+  G4double megaBytes = file ? (G4double)file.tellg() / (1024. * 1024.) : 0.;
+  G4double seconds = fElapsed.count();
+
+  G4cout << "\n----> TrackingData (" << backend << "): " << fNumRecords << " records, "
+         << megaBytes << " MB in " << fileName << ", write time " << seconds << " s";
+  if (seconds > 0)
+    G4cout << " (" << fNumRecords / seconds << " records/s, "
+           << megaBytes / seconds << " MB/s)";
+  G4cout << G4endl;
+}
@@ -0,0 +1,146 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file TreeTrackingWriter.cc
+/// \brief Implementation of the TreeTrackingWriter class
+
+#include "TreeTrackingWriter.hh"
+
+#ifdef ALPHABEAM_WITH_ROOT
+
+#include "InfoTree.hh"
+#include "VoxelEntryRecord.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4Threading.hh"
+#include "TFile.h"
+#include "TTree.h"
+
+namespace
+{
+// per-branch basket buffer and flush interval (negative: bytes)
+const G4int kBasketSize = 256 * 1024;
+const G4long kAutoFlush = -32 * 1024 * 1024;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+TreeTrackingWriter::TreeTrackingWriter(G4int compression)
+    : fCompression(compression)
+{
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+TreeTrackingWriter::~TreeTrackingWriter()
+{
+  delete fFile;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool TreeTrackingWriter::Open(const G4String &fileName)
+{
+  fFileName = fileName;
+  if (!G4StrUtil::ends_with(fFileName, ".root"))
+    fFileName += ".root";
+  if (!G4Threading::IsMasterThread())
+    fFileName.insert(fFileName.size() - 5, "_t" + std::to_string(G4Threading::G4GetThreadId()));
+
+  fFile = TFile::Open(fFileName.c_str(), "RECREATE", "alphaBeam", fCompression);
+  if (fFile == nullptr || fFile->IsZombie())
+  {
+    G4cout << "\n---> TreeTrackingWriter::Open(): cannot open " << fFileName << G4endl;
+    delete fFile;
+    fFile = nullptr;
+    return false;
+  }
+  G4cout << "\n----> TTree file is opened in " << fFileName
+         << " (compression " << fCompression << ")" << G4endl;
+
+  fTree = new TTree("TrackingData", "TrackingData");
+  fTree->Branch("EventID", &fEventID, "EventID/I", kBasketSize);
+  fTree->Branch("particleEnergy_MeV", &fEnergy, "particleEnergy_MeV/F", kBasketSize);
+  fTree->Branch("eDep_MeV", &fEDep, "eDep_MeV/F", kBasketSize);
+  fTree->Branch("particleID", &fParticleID, "particleID/b", kBasketSize);
+  fTree->Branch("copyNo", &fCopyNo, "copyNo/I", kBasketSize);
+  fTree->Branch("posX", &fPosX, "posX/F", kBasketSize);
+  fTree->Branch("posY", &fPosY, "posY/F", kBasketSize);
+  fTree->Branch("posZ", &fPosZ, "posZ/F", kBasketSize);
+  fTree->Branch("stepLength", &fStepLength, "stepLength/F", kBasketSize);
+  fTree->Branch("trackID", &fTrackID, "trackID/I", kBasketSize);
+  fTree->Branch("parentID", &fParentID, "parentID/I", kBasketSize);
+  fTree->Branch("entry", &fEntry, "entry/I", kBasketSize);
+  fTree->Branch("pdg", &fPdg, "pdg/I", kBasketSize);
+  fTree->SetAutoFlush(kAutoFlush);
+
+  fNumRecords = 0;
+  return true;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void TreeTrackingWriter::Fill(const VoxelEntryRecord &record)
+{
+  if (fTree == nullptr)
+    return;
+  StartTimer();
+  fEventID = record.eventID;
+  fEnergy = record.kineticEnergy / MeV;
+  fEDep = record.energyDeposit / MeV;
+  fParticleID = (std::uint8_t)record.particleID;
+  fCopyNo = record.copyNo;
+  fPosX = record.worldPosition.x() / nanometer;
+  fPosY = record.worldPosition.y() / nanometer;
+  fPosZ = record.worldPosition.z() / nanometer;
+  fStepLength = record.stepLength;
+  fTrackID = record.trackID;
+  fParentID = record.parentID;
+  fEntry = record.entry;
+  fPdg = record.pdg;
+  fTree->Fill();
+  fNumRecords++;
+  StopTimer();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void TreeTrackingWriter::Close(const RunInfo &info)
+{
+  if (fFile == nullptr)
+    return;
+  StartTimer();
+  WriteInfoTree(fFile, info);
+
+  fTree->Write();
+  fFile->Close();
+  delete fFile;
+  fFile = nullptr;
+  fTree = nullptr;
+  StopTimer();
+  PrintThroughput("tree", fFileName);
+}
+
+#endif
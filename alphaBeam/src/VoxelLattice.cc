@@ -0,0 +1,271 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file VoxelLattice.cc
+/// \brief Implementation of the VoxelLattice class
+
+#include "VoxelLattice.hh"
+#include "G4PhysicalConstants.hh"
+#include "G4SystemOfUnits.hh"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace
+{
+// index of the nearest voxel centre along one axis
+G4int NearestIndex(G4double offset, G4double spacing, G4int n)
+{
+  if (n <= 1 || spacing <= 0)
+    return 0;
+  return std::min(n - 1, std::max(0, (G4int)std::lround(offset / spacing)));
+}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+VoxelLattice::VoxelLattice(const G4ThreeVector &origin, G4double spacing,
+                           G4int nX, G4int nY, G4int nZ, G4double halfSize)
+    : fOrigin(origin), fSpacing(spacing), fNX(nX), fNY(nY), fNZ(nZ), fHalfSize(halfSize)
+{
+  G4ThreeVector half(halfSize, halfSize, halfSize);
+  fMin = origin - half;
+  fMax = origin + G4ThreeVector((nX - 1) * spacing, (nY - 1) * spacing, (nZ - 1) * spacing) + half;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+VoxelLattice::VoxelLattice(const std::vector<G4ThreeVector> &centres, G4double halfSize, G4bool spheres,
+                           const G4ThreeVector &binOrigin, G4double spacing)
+    : fOrigin(binOrigin), fSpacing(spacing), fHalfSize(halfSize), fSpheres(spheres)
+{
+  std::vector<Cell> cells;
+  cells.reserve(centres.size());
+  for (const G4ThreeVector &centre : centres)
+  {
+    G4ThreeVector bin = (centre - binOrigin) / spacing;
+    cells.push_back({centre, (G4int)std::floor(bin.x()), (G4int)std::floor(bin.y()), (G4int)std::floor(bin.z())});
+  }
+  SetCells(std::move(cells));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+VoxelLattice::VoxelLattice(G4double rMin, G4double shellSpacing, G4int numShells,
+                           G4double length, G4double spacing, G4double halfSize)
+    : fSpacing(spacing), fHalfSize(halfSize), fRMin(rMin), fShellSpacing(shellSpacing), fNumShells(numShells)
+{
+  // Unrotated cubes do not overlap when their centres are 2*sqrt(2)*h apart
+  // in the transverse plane, the diagonal of a face; the shells are that far
+  // apart radially, neighbours in a ring (by the chord) and rings along z.
+  G4double minPitch = 2 * std::sqrt(2.) * halfSize;
+  if (spacing < minPitch || (numShells > 1 && shellSpacing < minPitch) || rMin < spacing)
+  {
+    G4ExceptionDescription msg;
+    msg << "Radial cells of half-size " << halfSize / nm << " nm need spacing and shell spacing of at least "
+        << minPitch / nm << " nm, and an inner radius of at least the spacing";
+    G4Exception("VoxelLattice::VoxelLattice", "VoxelLattice001", FatalException, msg);
+    return;
+  }
+
+  fNumRings = std::max(1, (G4int)std::floor(length / spacing));
+  G4double z0 = -0.5 * (fNumRings - 1) * spacing;
+  std::vector<Cell> cells;
+  fShellFirst.push_back(0);
+  for (G4int k = 0; k < numShells; k++)
+  {
+    G4double radius = GetShellRadius(k);
+    G4int numAround = (G4int)std::floor(pi / std::asin(0.5 * spacing / radius));
+    for (G4int i = 0; i < numAround; i++)
+    {
+      G4double phi = twopi * i / numAround;
+      for (G4int j = 0; j < fNumRings; j++)
+        cells.push_back({G4ThreeVector(radius * std::cos(phi), radius * std::sin(phi), z0 + j * spacing), i, j, k});
+    }
+    fShellFirst.push_back((G4int)cells.size());
+  }
+  fOrigin = G4ThreeVector(0, 0, z0);
+  SetCells(std::move(cells));
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void VoxelLattice::SetCells(std::vector<Cell> &&cells)
+{
+  fExplicit = true;
+  fCells = std::move(cells);
+  fNX = (G4int)fCells.size();
+  fNY = 1;
+  fNZ = 1;
+
+  // one cell per hash cell: a cube's centre is 2h from any other, a
+  // sphere's 2h, which is the diagonal of a cell of side 2h/sqrt(3)
+  fHash.Reset(fSpheres ? 2 * fHalfSize / std::sqrt(3.) : 2 * fHalfSize, fCells.size());
+  G4ThreeVector half(fHalfSize, fHalfSize, fHalfSize);
+  fMin = fCells.empty() ? fOrigin : fCells[0].centre - half;
+  fMax = fCells.empty() ? fOrigin : fCells[0].centre + half;
+  for (std::size_t id = 0; id < fCells.size(); id++)
+  {
+    const G4ThreeVector &centre = fCells[id].centre;
+    fHash.Insert(centre, (G4int)id);
+    for (G4int axis = 0; axis < 3; axis++)
+    {
+      fMin[axis] = std::min(fMin[axis], centre[axis] - fHalfSize);
+      fMax[axis] = std::max(fMax[axis], centre[axis] + fHalfSize);
+    }
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool VoxelLattice::Contains(G4int voxelID, const G4ThreeVector &world, G4double tolerance) const
+{
+  G4ThreeVector local = world - fCells[voxelID].centre;
+  G4double limit = fHalfSize + tolerance;
+  if (fSpheres)
+    return local.mag2() <= limit * limit;
+  return std::abs(local.x()) <= limit && std::abs(local.y()) <= limit && std::abs(local.z()) <= limit;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4double VoxelLattice::DistanceToVoxel(G4int voxelID, const G4ThreeVector &world) const
+{
+  G4ThreeVector local = world - fCells[voxelID].centre;
+  if (fSpheres)
+    return std::max(0., local.mag() - fHalfSize);
+  G4double dx = std::max(0., std::abs(local.x()) - fHalfSize);
+  G4double dy = std::max(0., std::abs(local.y()) - fHalfSize);
+  G4double dz = std::max(0., std::abs(local.z()) - fHalfSize);
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4int VoxelLattice::FindShellCell(const G4ThreeVector &world, G4double tolerance) const
+{
+  // the nearest shell, ring and cell of the ring; with the pitches above
+  // no other cell can contain the point
+  G4int k = (G4int)std::lround((std::hypot(world.x(), world.y()) - fRMin) / fShellSpacing);
+  G4int j = (G4int)std::lround((world.z() - fOrigin.z()) / fSpacing);
+  if (fNumShells == 1)
+    k = 0;
+  if (k < 0 || k >= fNumShells || j < 0 || j >= fNumRings)
+    return -1;
+  G4int numAround = GetNumShellCells(k) / fNumRings;
+  G4double phi = std::atan2(world.y(), world.x());
+  if (phi < 0)
+    phi += twopi;
+  G4int i = (G4int)std::lround(phi / twopi * numAround) % numAround;
+  G4int id = fShellFirst[k] + i * fNumRings + j;
+  return Contains(id, world, tolerance) ? id : -1;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4int VoxelLattice::FindVoxelID(const G4ThreeVector &world, G4double tolerance) const
+{
+  if (fNumShells > 0)
+    return FindShellCell(world, tolerance);
+  if (fExplicit)
+  {
+    G4int found = -1;
+    G4int reach = (G4int)std::ceil((fHalfSize + tolerance) / fHash.GetCellSize());
+    fHash.ForEachNear(world, reach, [&](G4int id) {
+      if (found < 0 && Contains(id, world, tolerance))
+        found = id;
+    });
+    return found;
+  }
+
+  G4ThreeVector offset = world - fOrigin;
+  G4int i = NearestIndex(offset.x(), fSpacing, fNX);
+  G4int j = NearestIndex(offset.y(), fSpacing, fNY);
+  G4int k = NearestIndex(offset.z(), fSpacing, fNZ);
+  G4ThreeVector local = offset - G4ThreeVector(i * fSpacing, j * fSpacing, k * fSpacing);
+  G4double limit = fHalfSize + tolerance;
+  if (std::abs(local.x()) > limit || std::abs(local.y()) > limit || std::abs(local.z()) > limit)
+    return -1;
+  return GetVoxelID(i, j, k);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4bool VoxelLattice::IsInBoundingBox(const G4ThreeVector &world) const
+{
+  return world.x() > fMin.x() && world.x() < fMax.x() &&
+         world.y() > fMin.y() && world.y() < fMax.y() &&
+         world.z() > fMin.z() && world.z() < fMax.z();
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4double VoxelLattice::DistanceToBoundingBox(const G4ThreeVector &world) const
+{
+  G4double dx = std::max({0., fMin.x() - world.x(), world.x() - fMax.x()});
+  G4double dy = std::max({0., fMin.y() - world.y(), world.y() - fMax.y()});
+  G4double dz = std::max({0., fMin.z() - world.z(), world.z() - fMax.z()});
+  return std::sqrt(dx * dx + dy * dy + dz * dz);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+G4double VoxelLattice::DistanceToNearestVoxel(const G4ThreeVector &world) const
+{
+  if (fExplicit)
+  {
+    // widen the hash neighbourhood until the nearest cell found is closer
+    // than any cell beyond it could be; far from the cells a scan of the
+    // list is cheaper
+    G4double cellSize = fHash.GetCellSize();
+    G4double extent = fSpheres ? fHalfSize : fHalfSize * std::sqrt(3.);
+    G4double nearest = DBL_MAX;
+    for (G4int reach = 1;; reach *= 2)
+    {
+      G4double side = 2. * reach + 1;
+      if (side * side * side > (G4double)fCells.size())
+        break;
+      fHash.ForEachNear(world, reach, [&](G4int id) { nearest = std::min(nearest, DistanceToVoxel(id, world)); });
+      if (nearest <= reach * cellSize - extent)
+        return nearest;
+    }
+    for (G4int id = 0; id < (G4int)fCells.size(); id++)
+      nearest = std::min(nearest, DistanceToVoxel(id, world));
+    return nearest;
+  }
+
+  // the lattice is a product of 1D rows of slabs, so the nearest voxel is
+  // the nearest slab along each axis
+  G4ThreeVector offset = world - fOrigin;
+  G4double d[3];
+  const G4int n[3] = {fNX, fNY, fNZ};
+  for (G4int axis = 0; axis < 3; axis++)
+  {
+    G4int index = NearestIndex(offset[axis], fSpacing, n[axis]);
+    d[axis] = std::max(0., std::abs(offset[axis] - index * fSpacing) - fHalfSize);
+  }
+  return std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+}
@@ -0,0 +1,154 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file VoxelScorer.cc
+/// \brief Implementation of the VoxelScorer class
+
+#include "VoxelScorer.hh"
+#include "DetectorConstruction.hh"
+#include "G4RunManager.hh"
+#include "G4SystemOfUnits.hh"
+#include "G4AutoLock.hh"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+namespace
+{
+G4Mutex mergeMutex = G4MUTEX_INITIALIZER;
+}
+
+VoxelScorer *VoxelScorer::fgMasterInstance = nullptr;
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+VoxelScorer::VoxelScorer()
+{
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+VoxelScorer::~VoxelScorer()
+{
+  if (fgMasterInstance == this)
+    fgMasterInstance = nullptr;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void VoxelScorer::Reset(G4int nX, G4int nY, G4int nZ)
+{
+  fNX = nX;
+  fNY = nY;
+  fNZ = nZ;
+  std::size_t n = (std::size_t)nX * nY * nZ;
+  fEdep.assign(n, 0.);
+  fTrackLength.assign(n, 0.);
+  fEntries.assign(n, 0);
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void VoxelScorer::Merge(const VoxelScorer &other)
+{
+  G4AutoLock lock(&mergeMutex);
+  if (fEdep.size() != other.fEdep.size())
+  {
+    G4Exception("VoxelScorer::Merge", "VoxelScorer001", JustWarning,
+                "Voxel arrays differ in size, worker scores not merged.");
+    return;
+  }
+  for (std::size_t i = 0; i < fEdep.size(); i++)
+  {
+    fEdep[i] += other.fEdep[i];
+    fTrackLength[i] += other.fTrackLength[i];
+    fEntries[i] += other.fEntries[i];
+  }
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void VoxelScorer::Write(const G4String &fileName, G4int numEvents) const
+{
+  // File layout (little endian):
+  //   char[8]  "ABVOXEL1"
+  //   int32    ndiv_X, ndiv_Y, ndiv_Z, number of events
+  //   float    spacing [um], start_Z [um], voxel half-size [um], voxel mass [kg]
+  //   float    eDep [MeV]         x nVoxels
+  //   float    dose [Gy]          x nVoxels
+  //   float    fluence [cm-2]     x nVoxels (track length / voxel volume)
+  //   uint32   entries            x nVoxels
+  // Arrays are indexed by voxel ID = (i*ndiv_Y + j)*ndiv_Z + k; for the
+  // random placement ndiv is (number of cells, 1, 1) and the ID the cell's.
+  auto detector = (const DetectorConstruction *)G4RunManager::GetRunManager()->GetUserDetectorConstruction();
+
+  G4double halfSize = detector->get_voxelHalfSize();
+  G4double volume = detector->get_voxelVolume();
+  G4double mass = detector->get_voxelMass();
+
+  std::ofstream out(fileName, std::ios::out | std::ios::binary);
+  if (!out)
+  {
+    G4cout << "\n---> VoxelScorer::Write(): cannot open " << fileName << G4endl;
+    return;
+  }
+
+  char magic[8];
+  std::memcpy(magic, "ABVOXEL1", 8);
+  out.write(magic, sizeof(magic));
+
+  std::int32_t dims[4] = {fNX, fNY, fNZ, numEvents};
+  out.write((char *)dims, sizeof(dims));
+
+  float geometry[4] = {(float)(detector->get_spacing() / um),
+                       (float)(detector->get_start_Z() / um),
+                       (float)(halfSize / um),
+                       (float)(mass / kg)};
+  out.write((char *)geometry, sizeof(geometry));
+
+  std::size_t n = fEdep.size();
+  std::vector<float> buffer(n);
+
+  for (std::size_t i = 0; i < n; i++)
+    buffer[i] = fEdep[i] / MeV;
+  out.write((char *)buffer.data(), n * sizeof(float));
+
+  for (std::size_t i = 0; i < n; i++)
+    buffer[i] = fEdep[i] / mass / gray;
+  out.write((char *)buffer.data(), n * sizeof(float));
+
+  for (std::size_t i = 0; i < n; i++)
+    buffer[i] = fTrackLength[i] / volume * cm2;
+  out.write((char *)buffer.data(), n * sizeof(float));
+
+  std::vector<std::uint32_t> entries(n);
+  for (std::size_t i = 0; i < n; i++)
+    entries[i] = (std::uint32_t)std::min<G4long>(fEntries[i], UINT32_MAX);
+  out.write((char *)entries.data(), n * sizeof(std::uint32_t));
+
+  G4cout << "\n----> Voxel scores for " << n << " voxels written to " << fileName << G4endl;
+}
@@ -0,0 +1,185 @@
+//
+// ********************************************************************
+// * License and Disclaimer                                           *
+// *                                                                  *
+// * The  Geant4 software  is  copyright of the Copyright Holders  of *
+// * the Geant4 Collaboration.  It is provided  under  the terms  and *
+// * conditions of the Geant4 Software License,  included in the file *
+// * LICENSE and available at  http://cern.ch/geant4/license .  These *
+// * include a list of copyright holders.                             *
+// *                                                                  *
+// * Neither the authors of this software system, nor their employing *
+// * institutes,nor the agencies providing financial support for this *
+// * work  make  any representation or  warranty, express or implied, *
+// * regarding  this  software system or assume any liability for its *
+// * use.  Please see the license in the file  LICENSE  and URL above *
+// * for the full disclaimer and the limitation of liability.         *
+// *                                                                  *
+// * This  code  implementation is the result of  the  scientific and *
+// * technical work of the GEANT4 collaboration.                      *
+// * By using,  copying,  modifying or  distributing the software (or *
+// * any work based  on the software)  you  agree  to acknowledge its *
+// * use  in  resulting  scientific  publications,  and indicate your *
+// * acceptance of all terms of the Geant4 Software license.          *
+// ********************************************************************
+//
+//
+/// \file WorkerInitialization.cc
+/// \brief Implementation of the WorkerInitialization class
+
+#include "WorkerInitialization.hh"
+#include "G4Threading.hh"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace
+{
+// parses a sysfs cpu or node list such as "0-15,32-47"
+std::vector<G4int> ParseCPUList(const std::string &list)
+{
+  std::vector<G4int> cpus;
+  std::istringstream is(list);
+  std::string range;
+  while (std::getline(is, range, ','))
+  {
+    if (range.empty())
+      continue;
+    std::size_t dash = range.find('-');
+    G4int first = std::stoi(range.substr(0, dash));
+    G4int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+    for (G4int cpu = first; cpu <= last; cpu++)
+      cpus.push_back(cpu);
+  }
+  return cpus;
+}
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+WorkerInitialization::WorkerInitialization(Placement placement)
+    : G4UserWorkerInitialization(), fPlacement(placement)
+{
+#ifdef __linux__
+  // read once on the master, before any thread is pinned
+  fAllowedCPUs = AllowedCPUs();
+  if (fPlacement == Placement::Numa)
+    fNodeCPUs = NumaNodeCPUs(fAllowedCPUs);
+  if (fPlacement == Placement::Numa && fNodeCPUs.empty())
+  {
+    G4Exception("WorkerInitialization::WorkerInitialization", "WorkerInitialization001", JustWarning,
+                "no NUMA nodes found in /sys/devices/system/node, pinning to cores instead");
+    fPlacement = Placement::Core;
+  }
+#else
+  if (fPlacement != Placement::None)
+    G4Exception("WorkerInitialization::WorkerInitialization", "WorkerInitialization002", JustWarning,
+                "thread pinning is only supported on Linux");
+  fPlacement = Placement::None;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+WorkerInitialization::~WorkerInitialization()
+{
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+WorkerInitialization::Placement WorkerInitialization::ParsePlacement(const G4String &name)
+{
+  if (name.empty() || name == "none")
+    return Placement::None;
+  if (name == "core")
+    return Placement::Core;
+  if (name == "numa")
+    return Placement::Numa;
+
+  G4ExceptionDescription description;
+  description << "unknown thread placement '" << name << "', expected none, core or numa";
+  G4Exception("WorkerInitialization::ParsePlacement", "WorkerInitialization003", FatalException, description);
+  return Placement::None;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+void WorkerInitialization::WorkerInitialize() const
+{
+#ifdef __linux__
+  if (fPlacement == Placement::None || fAllowedCPUs.empty())
+    return;
+
+  G4int threadID = std::max(G4Threading::G4GetThreadId(), 0);
+  const std::vector<G4int> *cpus = &fAllowedCPUs;
+  std::vector<G4int> single;
+  if (fPlacement == Placement::Core)
+  {
+    single.push_back(fAllowedCPUs[threadID % fAllowedCPUs.size()]);
+    cpus = &single;
+  }
+  else
+    cpus = &fNodeCPUs[threadID % fNodeCPUs.size()];
+
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (G4int cpu : *cpus)
+    CPU_SET(cpu, &set);
+  if (sched_setaffinity(0, sizeof(set), &set) != 0)
+  {
+    G4ExceptionDescription description;
+    description << "cannot pin worker " << threadID;
+    G4Exception("WorkerInitialization::WorkerInitialize", "WorkerInitialization004", JustWarning, description);
+    return;
+  }
+  G4cout << "Worker " << threadID << " pinned to " << cpus->size() << " CPU(s) starting at " << cpus->front() << G4endl;
+#endif
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::vector<G4int> WorkerInitialization::AllowedCPUs()
+{
+  std::vector<G4int> cpus;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0)
+    for (G4int cpu = 0; cpu < CPU_SETSIZE; cpu++)
+      if (CPU_ISSET(cpu, &set))
+        cpus.push_back(cpu);
+#endif
+  return cpus;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+std::vector<std::vector<G4int>> WorkerInitialization::NumaNodeCPUs(const std::vector<G4int> &allowed)
+{
+  // node numbering may have gaps (offline or memoryless nodes), so the
+  // node IDs come from the online list rather than counting up
+  std::vector<std::vector<G4int>> nodes;
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string onlineList;
+  std::getline(online, onlineList);
+  for (G4int node : ParseCPUList(onlineList))
+  {
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    if (!file)
+      continue;
+    std::string list;
+    std::getline(file, list);
+
+    std::vector<G4int> cpus;
+    for (G4int cpu : ParseCPUList(list))
+      if (std::find(allowed.begin(), allowed.end(), cpu) != allowed.end())
+        cpus.push_back(cpu);
+    if (!cpus.empty())
+      nodes.push_back(cpus);
+  }
+  return nodes;
+}
@@ -0,0 +1,85 @@
+// Example record consumer (see include/RecordConsumer.hh): number of voxel
+// entries and their kinetic energy per Z layer and particle, written to
+// <out>_layers.txt at the end of each run.
+//
+//   alphaBeam -mac alphaBeam.in -consumer ./libLayerTally.so
+//   alphaBeam -mac alphaBeam.in -consumer ./libLayerTally.so:keV   energies in keV (default MeV)
+
+#include "RecordConsumer.hh"
+#include "G4SystemOfUnits.hh"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+const char *particleNames[] = {"", "e-", "gamma", "alpha", "proton", "ion", "other"};
+constexpr int kNumParticles = 7; // particleID 1..6, see ParticleSpecies.hh
+
+class LayerTally : public RecordConsumer
+{
+public:
+  explicit LayerTally(const char *args)
+  {
+    if (std::string(args) == "keV")
+    {
+      fUnit = keV;
+      fUnitName = "keV";
+    }
+  }
+
+  void BeginOfRun(const ConsumerRunInfo &info) override
+  {
+    fIsMaster = info.isMaster;
+    fFileName = std::string(info.outputBaseName) + "_layers.txt";
+    fCounts.assign(info.ndiv_Z * kNumParticles, 0);
+    fEnergies.assign(info.ndiv_Z * kNumParticles, 0.);
+  }
+
+  void ProcessRecords(RecordSpan records) override
+  {
+    for (const auto &record : records)
+    {
+      std::size_t bin = record.copyNo * kNumParticles + record.particleID;
+      if (bin >= fCounts.size())
+        continue;
+      fCounts[bin]++;
+      fEnergies[bin] += record.kineticEnergy;
+    }
+  }
+
+  void Merge(RecordConsumer &worker) override
+  {
+    auto &tally = (LayerTally &)worker;
+    for (std::size_t bin = 0; bin < fCounts.size() && bin < tally.fCounts.size(); bin++)
+    {
+      fCounts[bin] += tally.fCounts[bin];
+      fEnergies[bin] += tally.fEnergies[bin];
+    }
+  }
+
+  void EndOfRun(G4int numEvents) override
+  {
+    if (!fIsMaster)
+      return;
+    std::ofstream out(fFileName);
+    out << "# " << numEvents << " events\n# layer particle entries energy[" << fUnitName << "]\n";
+    for (std::size_t bin = 0; bin < fCounts.size(); bin++)
+      if (fCounts[bin] > 0)
+        out << bin / kNumParticles << " " << particleNames[bin % kNumParticles] << " "
+            << fCounts[bin] << " " << fEnergies[bin] / fUnit << "\n";
+  }
+
+private:
+  G4bool fIsMaster{true};
+  std::string fFileName;
+  G4double fUnit{MeV};
+  std::string fUnitName{"MeV"};
+  std::vector<long> fCounts;     // [layer][particleID]
+  std::vector<G4double> fEnergies;
+};
+
+}
+
+ALPHABEAM_RECORD_CONSUMER(LayerTally)
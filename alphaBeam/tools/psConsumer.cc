@@ -0,0 +1,142 @@
+// Minimal consumer of the alphaBeam phase-space stream, for testing the
+// fifo:, unix: and stdout: targets of -out (see PhaseSpaceWriter.hh).
+//
+//   psConsumer -listen /tmp/ps.sock [-delay ms]  listen, then run alphaBeam -out unix:/tmp/ps.sock
+//   psConsumer -fifo /tmp/ps.fifo [-delay ms]    read a named pipe (alphaBeam -out fifo:/tmp/ps.fifo)
+//   alphaBeam ... -out stdout: | psConsumer      read stdin
+//
+// Prints one line per event and totals at the end of the stream. -delay
+// sleeps after every batch to exercise backpressure on the transport side.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace
+{
+
+bool ReadFully(int fd, void *buffer, std::size_t size)
+{
+  char *p = (char *)buffer;
+  while (size > 0)
+  {
+    ssize_t n = ::read(fd, p, size);
+    if (n <= 0)
+      return false;
+    p += n;
+    size -= n;
+  }
+  return true;
+}
+
+int Listen(const std::string &path)
+{
+  sockaddr_un address;
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+  ::unlink(path.c_str());
+
+  int server = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (server < 0 || ::bind(server, (sockaddr *)&address, sizeof(address)) != 0 ||
+      ::listen(server, 1) != 0)
+  {
+    std::perror("psConsumer: listen");
+    std::exit(1);
+  }
+  std::fprintf(stderr, "psConsumer: listening on %s\n", path.c_str());
+  int fd = ::accept(server, nullptr, nullptr);
+  ::close(server);
+  return fd;
+}
+
+}
+
+int main(int argc, char **argv)
+{
+  int fd = STDIN_FILENO;
+  int delay = 0;
+  for (int i = 1; i + 1 < argc; i += 2)
+  {
+    std::string option = argv[i];
+    if (option == "-listen")
+      fd = Listen(argv[i + 1]);
+    else if (option == "-fifo")
+      fd = ::open(argv[i + 1], O_RDONLY);
+    else if (option == "-delay")
+      delay = std::atoi(argv[i + 1]);
+  }
+  if (fd < 0)
+  {
+    std::perror("psConsumer: open");
+    return 1;
+  }
+
+  std::uint32_t format = 0;
+  std::uint64_t eventRecords = 0, totalRecords = 0, totalEvents = 0, totalBytes = 0;
+  std::vector<char> payload;
+  std::uint32_t frame[2];
+
+  while (ReadFully(fd, frame, sizeof(frame)))
+  {
+    payload.resize(frame[1]);
+    if (frame[1] > 0 && !ReadFully(fd, payload.data(), frame[1]))
+      break;
+    totalBytes += sizeof(frame) + frame[1];
+
+    switch (frame[0])
+    {
+    case 1: // header
+    {
+      float halfSize;
+      std::memcpy(&format, payload.data() + 8, sizeof(format));
+      std::memcpy(&halfSize, payload.data() + 12, sizeof(halfSize));
+      std::printf("stream %.8s, format %u, voxel half-size %g mm\n",
+                  payload.data(), format, halfSize);
+      break;
+    }
+    case 2: // batch
+    {
+      // format bits 8 (lineage), 9 (voxel) and 10 (species) add 3, 2 and 3 floats
+      std::uint32_t width = 12 + ((format & 256) ? 3 : 0) + ((format & 512) ? 2 : 0) +
+                            ((format & 1024) ? 3 : 0);
+      std::uint32_t records = frame[1] / (width * sizeof(float));
+      if ((format & 255) != 0)
+        std::memcpy(&records, payload.data(), sizeof(records));
+      eventRecords += records;
+      if (delay > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+      break;
+    }
+    case 3: // end of event
+    {
+      std::int32_t eventID;
+      std::memcpy(&eventID, payload.data(), sizeof(eventID));
+      std::printf("event %d: %llu records\n", eventID, (unsigned long long)eventRecords);
+      totalRecords += eventRecords;
+      totalEvents++;
+      eventRecords = 0;
+      break;
+    }
+    case 4: // end of stream
+      std::printf("end of stream: %llu events, %llu records, %llu bytes\n",
+                  (unsigned long long)totalEvents, (unsigned long long)totalRecords,
+                  (unsigned long long)totalBytes);
+      return 0;
+    default:
+      std::fprintf(stderr, "psConsumer: unknown frame type %u\n", frame[0]);
+      return 1;
+    }
+  }
+  std::fprintf(stderr, "psConsumer: stream ended without end-of-stream frame\n");
+  return 1;
+}
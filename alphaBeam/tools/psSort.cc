@@ -0,0 +1,375 @@
+// Spatial sort of an alphaBeam phase-space file for the DNA/RBE clustering
+// stage: records are ordered by copyNo (the Z layer) and, within a layer,
+// by a Morton (Z-order) key over the voxel indices (i, j) and the local
+// (x, y), so records close together in the layer are close in the file.
+//
+//   psSort -in PSfile.bin -out sorted.bin [-lineage] [-species] [-halfsize mm]
+//          [-memory MB] [-block N]
+//
+// The input is a float-format file written with -psvoxel (and -lineage or
+// the species field of -species ion/other if given, see PhaseSpaceWriter.hh);
+// the output has the same layout. Records
+// with equal keys keep their file order. -halfsize is the voxel half-size
+// the local position is scaled by, found with an extra pass over the file
+// if not given.
+//
+// Input larger than -memory (default 1024 MB) is sorted in runs, written
+// next to the output as sorted.bin.runN, then merged; only one buffer per
+// run is held in memory, so files larger than RAM can be sorted.
+//
+// Next to the output, sorted.bin.idx lists blocks of up to -block records
+// (default 4096) of one layer, one per line:
+//   copyNo firstRecord numRecords keyMin keyMax iMin iMax jMin jMax
+// A reader after a spatial tile seeks to firstRecord of the blocks whose
+// i/j ranges overlap it; readPS.read_index() loads the index.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+// float-format columns, see PhaseSpaceWriter.hh
+const int kX = 0;
+const int kY = 1;
+const int kCopyNo = 9;
+const int kBaseFloats = 12;
+const int kLineageFloats = 3;
+const int kVoxelFloats = 2;
+const int kSpeciesFloats = 3;
+
+// sub-voxel resolution of the key: bits of the local position per axis
+const int kLocalBits = 10;
+
+struct Layout
+{
+  int width;     // floats per record
+  int i, j;      // columns of the voxel indices
+  double halfSize;
+};
+
+struct Key
+{
+  std::int32_t copyNo;
+  std::uint64_t morton;
+
+  bool operator<(const Key &other) const
+  {
+    return copyNo != other.copyNo ? copyNo < other.copyNo : morton < other.morton;
+  }
+};
+
+// the bits of v on the even bits of the result
+std::uint64_t Spread(std::uint32_t v)
+{
+  std::uint64_t x = v;
+  x = (x | (x << 16)) & 0x0000FFFF0000FFFFull;
+  x = (x | (x << 8)) & 0x00FF00FF00FF00FFull;
+  x = (x | (x << 4)) & 0x0F0F0F0F0F0F0F0Full;
+  x = (x | (x << 2)) & 0x3333333333333333ull;
+  x = (x | (x << 1)) & 0x5555555555555555ull;
+  return x;
+}
+
+std::uint32_t Quantise(float x, double halfSize)
+{
+  const std::uint32_t cells = 1u << kLocalBits;
+  double t = std::clamp(x / halfSize * 0.5 + 0.5, 0., 1.);
+  return std::min((std::uint32_t)(t * cells), cells - 1);
+}
+
+// voxel index in the high bits, local position in the low bits of each axis
+Key MakeKey(const float *record, const Layout &layout)
+{
+  std::uint32_t x = ((std::uint32_t)record[layout.i] << kLocalBits) | Quantise(record[kX], layout.halfSize);
+  std::uint32_t y = ((std::uint32_t)record[layout.j] << kLocalBits) | Quantise(record[kY], layout.halfSize);
+  return {(std::int32_t)record[kCopyNo], Spread(x) | (Spread(y) << 1)};
+}
+
+FILE *Open(const std::string &fileName, const char *mode)
+{
+  FILE *file = std::fopen(fileName.c_str(), mode);
+  if (file == nullptr)
+  {
+    std::perror(("psSort: " + fileName).c_str());
+    std::exit(1);
+  }
+  return file;
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Writes the sorted records and their block index
+class SortedWriter
+{
+public:
+  SortedWriter(const std::string &fileName, const Layout &layout, std::size_t blockSize)
+      : fLayout(layout), fBlockSize(blockSize)
+  {
+    fFile = Open(fileName, "wb");
+    fIndex = Open(fileName + ".idx", "w");
+    std::fprintf(fIndex, "copyNo firstRecord numRecords keyMin keyMax iMin iMax jMin jMax\n");
+  }
+
+  void Write(const float *record)
+  {
+    Key key = MakeKey(record, fLayout);
+    int i = (int)record[fLayout.i];
+    int j = (int)record[fLayout.j];
+    if (fCount > 0 && (key.copyNo != fCopyNo || fCount == fBlockSize))
+      FlushBlock();
+    if (fCount == 0)
+    {
+      fCopyNo = key.copyNo;
+      fFirst = fNumRecords;
+      fKeyMin = key.morton;
+      fIMin = fIMax = i;
+      fJMin = fJMax = j;
+    }
+    fKeyMax = key.morton; // keys ascend within a layer
+    fIMin = std::min(fIMin, i);
+    fIMax = std::max(fIMax, i);
+    fJMin = std::min(fJMin, j);
+    fJMax = std::max(fJMax, j);
+    fCount++;
+    fNumRecords++;
+    std::fwrite(record, sizeof(float), fLayout.width, fFile);
+  }
+
+  void Close()
+  {
+    if (fCount > 0)
+      FlushBlock();
+    std::fclose(fFile);
+    std::fclose(fIndex);
+  }
+
+  std::uint64_t GetNumRecords() const { return fNumRecords; }
+  std::uint64_t GetNumBlocks() const { return fNumBlocks; }
+  std::uint64_t GetNumLayers() const { return fNumLayers; }
+
+private:
+  void FlushBlock()
+  {
+    std::fprintf(fIndex, "%d %llu %llu %llu %llu %d %d %d %d\n", fCopyNo,
+                 (unsigned long long)fFirst, (unsigned long long)fCount,
+                 (unsigned long long)fKeyMin, (unsigned long long)fKeyMax, fIMin, fIMax, fJMin, fJMax);
+    if (fNumBlocks == 0 || fCopyNo != fLastCopyNo)
+      fNumLayers++;
+    fLastCopyNo = fCopyNo;
+    fNumBlocks++;
+    fCount = 0;
+  }
+
+  Layout fLayout;
+  std::size_t fBlockSize;
+  FILE *fFile;
+  FILE *fIndex;
+  std::uint64_t fNumRecords{0};
+  std::uint64_t fNumBlocks{0};
+  std::uint64_t fNumLayers{0};
+  std::int32_t fLastCopyNo{0};
+
+  // the block being filled
+  std::int32_t fCopyNo{0};
+  std::uint64_t fFirst{0};
+  std::size_t fCount{0};
+  std::uint64_t fKeyMin{0}, fKeyMax{0};
+  int fIMin{0}, fIMax{0}, fJMin{0}, fJMax{0};
+};
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+// Buffered reader of one sorted run
+class RunReader
+{
+public:
+  RunReader(const std::string &fileName, int width, std::size_t bufferRecords)
+      : fWidth(width), fBuffer(bufferRecords * width)
+  {
+    fFile = Open(fileName, "rb");
+  }
+  ~RunReader() { std::fclose(fFile); }
+
+  // nullptr at the end of the run
+  const float *Next()
+  {
+    if (fPos == fCount)
+    {
+      fCount = std::fread(fBuffer.data(), sizeof(float) * fWidth, fBuffer.size() / fWidth, fFile);
+      fPos = 0;
+      if (fCount == 0)
+        return nullptr;
+    }
+    return fBuffer.data() + (fPos++) * fWidth;
+  }
+
+private:
+  int fWidth;
+  std::vector<float> fBuffer;
+  FILE *fFile;
+  std::size_t fPos{0};
+  std::size_t fCount{0};
+};
+
+// largest |x| or |y| in the file
+double FindHalfSize(FILE *in, int width)
+{
+  std::vector<float> buffer(65536 * width);
+  double halfSize = 0;
+  std::size_t n;
+  while ((n = std::fread(buffer.data(), sizeof(float) * width, 65536, in)) > 0)
+    for (std::size_t r = 0; r < n; r++)
+      halfSize = std::max({halfSize, (double)std::fabs(buffer[r * width + kX]),
+                           (double)std::fabs(buffer[r * width + kY])});
+  std::rewind(in);
+  return halfSize > 0 ? halfSize : 1;
+}
+
+}
+
+//....oooOO0OOooo........oooOO0OOooo........oooOO0OOooo........oooOO0OOooo....
+
+int main(int argc, char **argv)
+{
+  std::string inName, outName;
+  bool lineage = false;
+  bool species = false;
+  double halfSize = 0;
+  std::size_t memory = 1024;
+  std::size_t blockSize = 4096;
+  for (int a = 1; a < argc; a++)
+  {
+    std::string option = argv[a];
+    if (option == "-lineage")
+      lineage = true;
+    else if (option == "-species")
+      species = true;
+    else if (a + 1 == argc)
+      break;
+    else if (option == "-in")
+      inName = argv[++a];
+    else if (option == "-out")
+      outName = argv[++a];
+    else if (option == "-halfsize")
+      halfSize = std::atof(argv[++a]);
+    else if (option == "-memory")
+      memory = std::atol(argv[++a]);
+    else if (option == "-block")
+      blockSize = std::atol(argv[++a]);
+  }
+  if (inName.empty() || outName.empty() || memory == 0 || blockSize == 0)
+  {
+    std::fprintf(stderr, "usage: psSort -in PSfile.bin -out sorted.bin [-lineage] [-species] "
+                         "[-halfsize mm] [-memory MB] [-block N]\n");
+    return 1;
+  }
+  auto start = std::chrono::steady_clock::now();
+
+  Layout layout;
+  // the species field follows the voxel indices
+  layout.i = kBaseFloats + (lineage ? kLineageFloats : 0);
+  layout.j = layout.i + 1;
+  layout.width = layout.i + kVoxelFloats + (species ? kSpeciesFloats : 0);
+  const std::size_t recordBytes = layout.width * sizeof(float);
+
+  FILE *in = Open(inName, "rb");
+  fseeko(in, 0, SEEK_END);
+  std::uint64_t fileSize = ftello(in);
+  std::rewind(in);
+  if (fileSize % recordBytes != 0)
+  {
+    std::fprintf(stderr, "psSort: %s is not a whole number of %zu-byte records; was it written "
+                         "with -psvoxel%s%s?\n", inName.c_str(), recordBytes,
+                 lineage ? ", -lineage" : "", species ? ", -species ion/other" : "");
+    return 1;
+  }
+  std::uint64_t numRecords = fileSize / recordBytes;
+  layout.halfSize = halfSize > 0 ? halfSize : FindHalfSize(in, layout.width);
+
+  // pass 1: sort chunks that fit in memory, record, key and order index each
+  std::size_t chunkRecords = std::max<std::size_t>(
+      1, memory * 1024 * 1024 / (recordBytes + sizeof(Key) + sizeof(std::uint32_t)));
+  chunkRecords = std::min<std::uint64_t>(chunkRecords, std::max<std::uint64_t>(numRecords, 1));
+  bool singleRun = numRecords <= chunkRecords;
+  std::vector<std::string> runs;
+  SortedWriter writer(outName, layout, blockSize);
+  {
+    std::vector<float> records(chunkRecords * layout.width);
+    std::vector<Key> keys(chunkRecords);
+    std::vector<std::uint32_t> order(chunkRecords);
+    std::size_t n;
+    while ((n = std::fread(records.data(), recordBytes, chunkRecords, in)) > 0)
+    {
+      for (std::size_t r = 0; r < n; r++)
+        keys[r] = MakeKey(records.data() + r * layout.width, layout);
+      order.resize(n);
+      std::iota(order.begin(), order.end(), 0);
+      std::stable_sort(order.begin(), order.end(),
+                       [&keys](std::uint32_t a, std::uint32_t b) { return keys[a] < keys[b]; });
+
+      if (singleRun)
+      {
+        for (std::uint32_t r : order)
+          writer.Write(records.data() + r * layout.width);
+        continue;
+      }
+      runs.push_back(outName + ".run" + std::to_string(runs.size()));
+      FILE *run = Open(runs.back(), "wb");
+      for (std::uint32_t r : order)
+        std::fwrite(records.data() + r * layout.width, recordBytes, 1, run);
+      std::fclose(run);
+    }
+  }
+  std::fclose(in);
+
+  // pass 2: merge the runs, ties in run order so that equal keys stay in
+  // file order
+  if (!runs.empty())
+  {
+    std::size_t bufferRecords = std::max<std::size_t>(1, memory * 1024 * 1024 / recordBytes / runs.size());
+    std::vector<std::unique_ptr<RunReader>> readers;
+    using Head = std::pair<Key, std::size_t>;
+    auto later = [](const Head &a, const Head &b) {
+      return b.first < a.first || (!(a.first < b.first) && a.second > b.second);
+    };
+    std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+    std::vector<const float *> current(runs.size());
+    for (std::size_t r = 0; r < runs.size(); r++)
+    {
+      readers.push_back(std::make_unique<RunReader>(runs[r], layout.width, bufferRecords));
+      if ((current[r] = readers[r]->Next()))
+        heads.push({MakeKey(current[r], layout), r});
+    }
+    while (!heads.empty())
+    {
+      std::size_t r = heads.top().second;
+      heads.pop();
+      writer.Write(current[r]);
+      if ((current[r] = readers[r]->Next()))
+        heads.push({MakeKey(current[r], layout), r});
+    }
+    readers.clear();
+    for (const std::string &run : runs)
+      std::remove(run.c_str());
+  }
+  writer.Close();
+
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  std::printf("psSort: %llu records in %llu layers, %llu index blocks, %zu runs, half-size %g mm, %.1f s\n",
+              (unsigned long long)writer.GetNumRecords(), (unsigned long long)writer.GetNumLayers(),
+              (unsigned long long)writer.GetNumBlocks(), std::max<std::size_t>(runs.size(), 1),
+              layout.halfSize, seconds);
+  return 0;
+}